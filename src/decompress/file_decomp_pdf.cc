@@ -29,6 +29,7 @@
 #include <stdlib.h>
 #include <zlib.h>
 
+#include "decompress/inflate_pool.h"
 #include "main/thread.h"
 #include "utils/util.h"
 
@@ -913,24 +914,20 @@ static fd_status_t Init_Stream(fd_session_p_t SessionPtr)
     {
     case FILE_COMPRESSION_TYPE_DEFLATE:
     {
-        int z_ret;
-
-        z_stream* z_s = &(StPtr->PDF_Decomp_State.Deflate.StreamDeflate);
-
-        memset( (char*)z_s, 0, sizeof(z_stream));
-
-        z_s->zalloc = (alloc_func)NULL;
-        z_s->zfree = (free_func)NULL;
-        SYNC_IN(z_s)
+        /* Streams come from a per thread pool so consecutive FlateDecode
+           objects reuse the zlib state and window. */
+        z_stream* z_s = InflatePool::acquire(47);
 
-        z_ret = inflateInit2(z_s, 47);
+        StPtr->PDF_Decomp_State.Deflate.StreamDeflate = z_s;
 
-        if ( z_ret != Z_OK )
+        if ( z_s == NULL )
         {
             File_Decomp_Alert(SessionPtr, FILE_DECOMP_ERR_PDF_DEFL_FAILURE);
             return( File_Decomp_Error );
         }
 
+        SYNC_IN(z_s)
+
         break;
     }
     default:
@@ -956,7 +953,7 @@ static fd_status_t Decomp_Stream(fd_session_p_t SessionPtr)
     case FILE_COMPRESSION_TYPE_DEFLATE:
     {
         int z_ret;
-        z_stream* z_s = &(StPtr->PDF_Decomp_State.Deflate.StreamDeflate);
+        z_stream* z_s = StPtr->PDF_Decomp_State.Deflate.StreamDeflate;
 
         SYNC_IN(z_s)
 
@@ -1015,16 +1012,9 @@ fd_status_t File_Decomp_End_PDF(fd_session_p_t SessionPtr)
     {
     case FILE_COMPRESSION_TYPE_DEFLATE:
     {
-        int z_ret;
-        z_stream* z_s = &(StPtr->PDF_Decomp_State.Deflate.StreamDeflate);
-
-        z_ret = inflateEnd(z_s);
-
-        if ( z_ret != Z_OK )
-        {
-            File_Decomp_Alert(SessionPtr, FILE_DECOMP_ERR_PDF_DEFL_FAILURE);
-            return( File_Decomp_Error );
-        }
+        /* Return the stream to the pool; it is reset when next acquired. */
+        InflatePool::release(StPtr->PDF_Decomp_State.Deflate.StreamDeflate);
+        StPtr->PDF_Decomp_State.Deflate.StreamDeflate = NULL;
 
         break;
     }
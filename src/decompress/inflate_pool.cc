@@ -0,0 +1,140 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// inflate_pool.cc
+
+#include "inflate_pool.h"
+
+#include <string.h>
+
+#include "main/thread.h"
+
+#ifdef UNIT_TEST
+#include "catch/catch.hpp"
+#endif
+
+#define MAX_POOLED_STREAMS 8
+
+struct InflateStreams
+{
+    z_stream* streams[MAX_POOLED_STREAMS];
+    unsigned count;
+};
+
+static THREAD_LOCAL InflateStreams pool;
+
+z_stream* InflatePool::acquire(int window_bits)
+{
+    while ( pool.count )
+    {
+        z_stream* z_s = pool.streams[--pool.count];
+        z_s->next_in = Z_NULL;
+        z_s->avail_in = 0;
+
+        if ( inflateReset2(z_s, window_bits) == Z_OK )
+            return z_s;
+
+        inflateEnd(z_s);
+        delete z_s;
+    }
+
+    z_stream* z_s = new z_stream;
+    memset(z_s, 0, sizeof(*z_s));
+    z_s->zalloc = Z_NULL;
+    z_s->zfree = Z_NULL;
+    z_s->next_in = Z_NULL;
+    z_s->avail_in = 0;
+
+    if ( inflateInit2(z_s, window_bits) != Z_OK )
+    {
+        delete z_s;
+        return nullptr;
+    }
+    return z_s;
+}
+
+void InflatePool::release(z_stream* z_s)
+{
+    if ( !z_s )
+        return;
+
+    if ( pool.count < MAX_POOLED_STREAMS )
+    {
+        pool.streams[pool.count++] = z_s;
+        return;
+    }
+    inflateEnd(z_s);
+    delete z_s;
+}
+
+void InflatePool::thread_term()
+{
+    while ( pool.count )
+    {
+        z_stream* z_s = pool.streams[--pool.count];
+        inflateEnd(z_s);
+        delete z_s;
+    }
+}
+
+//--------------------------------------------------------------------------
+// unit tests
+//--------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+static unsigned inflate_all(z_stream* z_s, const uint8_t* in, unsigned in_len,
+    uint8_t* out, unsigned out_len)
+{
+    z_s->next_in = (Bytef*)in;
+    z_s->avail_in = in_len;
+    z_s->next_out = out;
+    z_s->avail_out = out_len;
+
+    if ( inflate(z_s, Z_SYNC_FLUSH) != Z_STREAM_END )
+        return 0;
+
+    return out_len - z_s->avail_out;
+}
+
+TEST_CASE("inflate pool reuse", "[inflate_pool]")
+{
+    const char* text = "compressed once, inflated twice";
+    uint8_t packed[128];
+    uLongf packed_len = sizeof(packed);
+
+    // zlib format
+    REQUIRE(compress(packed, &packed_len, (const Bytef*)text, strlen(text)) == Z_OK);
+
+    z_stream* first = InflatePool::acquire(15);
+    REQUIRE(first != nullptr);
+
+    uint8_t out[128];
+    CHECK(inflate_all(first, packed, packed_len, out, sizeof(out)) == strlen(text));
+    InflatePool::release(first);
+
+    // the released stream is handed back, reset for a new stream
+    // auto detect gzip or zlib this time
+    z_stream* second = InflatePool::acquire(47);
+    CHECK(second == first);
+    CHECK(inflate_all(second, packed, packed_len, out, sizeof(out)) == strlen(text));
+    CHECK(!memcmp(out, text, strlen(text)));
+
+    InflatePool::release(second);
+    InflatePool::thread_term();
+}
+#endif
+
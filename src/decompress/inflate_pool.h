@@ -0,0 +1,47 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// inflate_pool.h
+
+#ifndef INFLATE_POOL_H
+#define INFLATE_POOL_H
+
+// zlib allocates the inflate state in inflateInit2() and the 32 KiB window
+// on first use, and frees both in inflateEnd().  Every compressed HTTP body
+// and every FlateDecode stream in a PDF pays for that.  InflatePool keeps a
+// few ended streams per packet thread and hands them back out after an
+// inflateReset2() which keeps the allocations.
+
+#include <zlib.h>
+
+#include "main/snort_types.h"
+
+class SO_PUBLIC InflatePool
+{
+public:
+    // returns a stream ready for inflate() or nullptr if zlib fails
+    static z_stream* acquire(int window_bits);
+
+    // the stream must not be used after this; nullptr is ok
+    static void release(z_stream*);
+
+    // free the streams kept by the current thread
+    static void thread_term();
+};
+
+#endif
+
@@ -346,7 +346,8 @@ int detection_option_node_evaluate(
     if ( !node )
         return 0;
 
-    auto& state = node->state[get_instance_id()];
+    const unsigned instance_id = get_instance_id();
+    auto& state = node->state[instance_id];
     RuleContext profile(state);
 
     int result = 0;
@@ -391,19 +392,11 @@ int detection_option_node_evaluate(
     state.last_check.rebuild_flag = p->packet_flags & PKT_REBUILT_STREAM;
 
     // Save some stuff off for repeated pattern tests
-    bool try_again = false;
+    bool try_again = node->retry;
     PmdLastCheck* content_last = nullptr;
 
-    if ( node->option_type != RULE_OPTION_TYPE_LEAF_NODE )
-    {
-        IpsOption* opt = (IpsOption*)node->option_data;
-        try_again = opt->retry();
-
-        PatternMatchData* pmd = opt->get_pattern(0, RULE_WO_DIR);
-
-        if ( pmd and pmd->last_check )
-            content_last = pmd->last_check + get_instance_id();
-    }
+    if ( node->pmd and node->pmd->last_check )
+        content_last = node->pmd->last_check + instance_id;
 
     // No, haven't evaluated this one before... Check it.
     do
@@ -461,7 +454,7 @@ int detection_option_node_evaluate(
 
                 if ( f_result )
                 {
-                    otn->state[get_instance_id()].matches++;
+                    otn->state[instance_id].matches++;
 
                     if ( !eval_data->flowbit_noalert )
                     {
@@ -545,9 +538,10 @@ int detection_option_node_evaluate(
             eval_data->flowbit_noalert = 1;
         }
 
-        // Back up byte_extract vars so they don't get overwritten between rules
-        for ( int i = 0; i < NUM_BYTE_EXTRACT_VARS; ++i )
-            GetByteExtractValue(&(tmp_byte_extract_vars[i]), (int8_t)i);
+        // Back up byte_extract vars so they don't get overwritten between rules;
+        // the first child sees them as they are so only siblings need them
+        if ( node->num_children > 1 )
+            GetByteExtractValues(tmp_byte_extract_vars);
 
         if ( PacketLatency::fastpath() )
         {
@@ -567,10 +561,10 @@ int detection_option_node_evaluate(
                         node->children[i];
 
                     dot_node_state_t* child_state =
-                        child_node->state + get_instance_id();
+                        child_node->state + instance_id;
 
-                    for ( int j = 0; j < NUM_BYTE_EXTRACT_VARS; ++j )
-                        SetByteExtractValue(tmp_byte_extract_vars[j], (int8_t)j);
+                    if ( i > 0 )
+                        SetByteExtractValues(tmp_byte_extract_vars);
 
                     if ( loop_count > 0 )
                     {
@@ -594,10 +588,9 @@ int detection_option_node_evaluate(
                                 // Check for an unbounded relative search.  If this
                                 // failed before, it's going to fail again so don't
                                 // go down this path again
-                                IpsOption* opt = (IpsOption*)node->option_data;
-                                PatternMatchData* pmd = opt->get_pattern(0, RULE_WO_DIR);
+                                PatternMatchData* pmd = node->pmd;
 
-                                if ( pmd->unbounded() )
+                                if ( pmd and pmd->unbounded() )
                                 {
                                     // Only increment result once. Should hit this
                                     // condition on first loop iteration
@@ -812,8 +805,11 @@ detection_option_tree_root_t* new_root(OptTreeNode* otn)
     detection_option_tree_root_t* p = (detection_option_tree_root_t*)
         snort_calloc(sizeof(detection_option_tree_root_t));
 
+    static unsigned root_count = 0;
+
     p->latency_state = new RuleLatencyState[ThreadConfig::get_instance_max()]();
     p->otn = otn;
+    p->id = ++root_count;
 
     return p;
 }
@@ -839,11 +835,24 @@ detection_option_tree_node_t* new_node(
     detection_option_tree_node_t* p =
         (detection_option_tree_node_t*)snort_calloc(sizeof(*p));
 
+    static unsigned node_count = 0;
+
     p->option_type = type;
     p->option_data = data;
+    p->id = ++node_count;
+
+    if ( type != RULE_OPTION_TYPE_LEAF_NODE )
+    {
+        IpsOption* opt = (IpsOption*)data;
+        p->retry = opt->retry();
+
+        // other options may build their pattern on demand
+        if ( type == RULE_OPTION_TYPE_CONTENT )
+            p->pmd = opt->get_pattern(0, RULE_WO_DIR);
+    }
 
-    p->state = (dot_node_state_t*)
-        snort_calloc(ThreadConfig::get_instance_max(), sizeof(*p->state));
+    p->state = (dot_node_state_t*)snort_calloc_aligned(
+        alignof(dot_node_state_t), ThreadConfig::get_instance_max(), sizeof(*p->state));
 
     return p;
 }
@@ -856,7 +865,7 @@ void free_detection_option_tree(detection_option_tree_node_t* node)
         free_detection_option_tree(node->children[i]);
     }
     snort_free(node->children);
-    snort_free(node->state);
+    snort_free_aligned(node->state);
     snort_free(node);
 }
 
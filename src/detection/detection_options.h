@@ -29,7 +29,8 @@
 //
 // These trees are instantiated at parse time, one per MPSE match state.
 // Eval, profiling, and latency data are attached in an array sized per max
-// packet threads.
+// packet threads.  The node state is written on every evaluation so each
+// element gets its own cache line.
 
 #ifdef HAVE_CONFIG_H
 #include "config.h"
@@ -38,16 +39,18 @@
 #include <sys/time.h>
 #include "detection/rule_option_types.h"
 #include "main/snort_types.h"
+#include "main/thread.h"
 #include "latency/rule_latency_state.h"
 #include "time/clock_defs.h"
 
 struct Packet;
+struct PatternMatchData;
 struct SFXHASH;
 
 typedef int (* eval_func_t)(void* option_data, class Cursor&, Packet*);
 
 // this is per packet thread
-struct dot_node_state_t
+struct alignas(CACHE_LINE_SIZE) dot_node_state_t
 {
     int result;
     struct
@@ -93,6 +96,13 @@ struct detection_option_tree_node_t
     option_type_t option_type;
     detection_option_tree_node_t** children;
     dot_node_state_t* state;
+
+    // taken from the option when the node is created so evaluation does
+    // not have to make these virtual calls each time through
+    PatternMatchData* pmd;  // content only
+    bool retry;
+
+    unsigned id;  // creation order; fixes evaluation order across runs
 };
 
 struct detection_option_tree_root_t
@@ -102,6 +112,7 @@ struct detection_option_tree_root_t
     RuleLatencyState* latency_state;
 
     struct OptTreeNode* otn;  // first rule in tree
+    unsigned id;              // creation order
 };
 
 struct detection_option_eval_data_t
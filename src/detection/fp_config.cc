@@ -40,6 +40,7 @@ FastPatternConfig::FastPatternConfig()
 
     inspect_stream_insert = false;
     max_queue_events = 5;
+    queue_limit = 128;
     bleedover_port_limit = 1024;
 
     search_api = MpseManager::get_search_api("ac_bnfa");
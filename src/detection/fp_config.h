@@ -58,6 +58,18 @@ public:
     unsigned get_max_queue_events()
     { return max_queue_events; }
 
+    void set_queue_limit(unsigned int num_matches)
+    { queue_limit = num_matches; }
+
+    unsigned get_queue_limit()
+    { return queue_limit; }
+
+    void set_compile_threads(unsigned n)
+    { compile_threads = n; }
+
+    unsigned get_compile_threads()
+    { return compile_threads; }
+
     int get_single_rule_group()
     { return portlists_flags & PL_SINGLE_RULE_GROUP; }
 
@@ -151,6 +163,8 @@ private:
     bool debug;
 
     unsigned max_queue_events;
+    unsigned queue_limit;
+    unsigned compile_threads;  // 0 means one per cpu
     unsigned bleedover_port_limit;
 
     int search_opt;
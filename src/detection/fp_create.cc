@@ -39,6 +39,10 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "main/snort_config.h"
 #include "hash/sfghash.h"
 #include "ips_options/ips_flow.h"
@@ -68,6 +72,7 @@
 #include "pattern_match_data.h"
 
 static unsigned mpse_count = 0;
+static std::vector<Mpse*> mpse_queue;
 static const char* s_group = "";
 
 static void fpDeletePMX(void* data);
@@ -415,13 +420,8 @@ static int fpFinishPortGroup(
         {
             if (pg->mpse[i]->get_pattern_count() != 0)
             {
-                if (pg->mpse[i]->prep_patterns(sc) != 0)
-                {
-                    FatalError("Failed to compile port group patterns.\n");
-                }
-
-                if (fp->get_debug_mode())
-                    pg->mpse[i]->print_info();
+                // compiled by fpCompileMpses() when all groups are built
+                mpse_queue.push_back(pg->mpse[i]);
                 rules = 1;
             }
             else
@@ -1480,6 +1480,78 @@ static void fp_print_port_groups(RulePortTables* port_tables)
     }
 }
 
+// the state machines are the bulk of startup time and each is
+// independent so engines that support it are compiled on worker threads.
+// the rest (detection option trees, summary stats) touches shared state
+// and is done here in queue order so the result is the same regardless
+// of thread count or scheduling.
+
+// each worker only writes the results of the mpses it took from the queue
+struct MpseResult
+{
+    int rval = 0;
+    bool compiled = false;
+};
+
+static void fpCompileMpseWorker(
+    std::atomic<unsigned>* next, std::vector<MpseResult>* results)
+{
+    unsigned i;
+
+    while ( (i = (*next)++) < mpse_queue.size() )
+    {
+        if ( mpse_queue[i]->can_compile_parallel() )
+        {
+            (*results)[i].rval = mpse_queue[i]->compile();
+            (*results)[i].compiled = true;
+        }
+    }
+}
+
+static void fpCompileMpses(SnortConfig* sc, FastPatternConfig* fp)
+{
+    unsigned max = fp->get_compile_threads();
+
+    if ( !max )
+        max = std::thread::hardware_concurrency();
+
+    if ( max > mpse_queue.size() )
+        max = mpse_queue.size();
+
+    std::vector<MpseResult> results(mpse_queue.size());
+
+    if ( max > 1 )
+    {
+        std::atomic<unsigned> next(0);
+        std::vector<std::thread> workers;
+
+        for ( unsigned i = 0; i < max; ++i )
+            workers.emplace_back(fpCompileMpseWorker, &next, &results);
+
+        for ( auto& w : workers )
+            w.join();
+    }
+
+    for ( unsigned i = 0; i < mpse_queue.size(); ++i )
+    {
+        Mpse* mpse = mpse_queue[i];
+        int rval = results[i].rval;
+
+        if ( !results[i].compiled )
+            rval = mpse->prep_patterns(sc);
+
+        else if ( !rval )
+            rval = mpse->finish(sc);
+
+        if ( rval )
+            FatalError("Failed to compile port group patterns.\n");
+
+        if ( fp->get_debug_mode() )
+            mpse->print_info();
+    }
+    mpse_queue.clear();
+}
+
 /*
  *  Build Service based PortGroups using the rules
  *  metadata option service parameter.
@@ -1568,6 +1640,8 @@ int fpCreateFastPacketDetection(SnortConfig* sc)
     if (fp->get_debug_print_rule_group_build_details())
         LogMessage("Service Based Rule Maps Done....\n");
 
+    fpCompileMpses(sc, fp);
+
     fp_print_port_groups(port_tables);
     fp_print_service_groups(sc->spgmmTable);
 
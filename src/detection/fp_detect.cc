@@ -42,6 +42,8 @@
 
 #include <strings.h>
 
+#include <algorithm>
+
 #include "detect.h"
 #include "fp_config.h"
 #include "fp_create.h"
@@ -91,6 +93,51 @@ THREAD_LOCAL uint64_t rule_eval_pkt_count = 0;
 
 static THREAD_LOCAL OTNX_MATCH_DATA t_omd;
 
+// fast pattern hits are queued per search so that each rule tree is only
+// evaluated once no matter how many of its patterns hit.  duplicates are
+// found with a small open addressed set of tree pointers that is cleared
+// by bumping the generation.  the queue is evaluated in order of the first
+// option node's id and then the tree's id so that trees which share their
+// first option node run back to back in the same order on every run.
+class MpseStash
+{
+public:
+    void init();
+    void term();
+
+    bool push(void* user, void* tree, int index, void* list);
+    void process(MpseMatch, void*);
+
+private:
+    void forget();
+    bool seen(void* tree);
+
+    struct Node
+    {
+        void* user;
+        void* tree;
+        void* list;
+        int index;
+    };
+
+    struct Slot
+    {
+        void* tree;
+        unsigned gen;
+    };
+
+    Node* queue;
+    Slot* slots;
+
+    unsigned max;
+    unsigned mask;
+    unsigned count;
+    unsigned flushed;
+    unsigned gen;
+};
+
+static THREAD_LOCAL MpseStash stash;
+
 /* initialize the global OTNX_MATCH_DATA variable */
 void otnx_match_data_init(int num_rule_types)
 {
@@ -104,6 +151,7 @@ void otnx_match_data_term()
         snort_free(t_omd.matchInfo);
 
     t_omd.matchInfo = nullptr;
+    stash.term();
 }
 
 // Initialize the OTNX_MATCH_DATA structure.  We do this for
@@ -240,6 +288,71 @@ int fpLogEvent(const RuleTreeNode* rtn, const OptTreeNode* otn, Packet* p)
     return 0;
 }
 
+static int sortOrderByPriority(const void* e1, const void* e2)
+{
+    OptTreeNode* otn1;
+    OptTreeNode* otn2;
+
+    if (!e1 || !e2)
+        return 0;
+
+    otn1 = *(OptTreeNode**)e1;
+    otn2 = *(OptTreeNode**)e2;
+
+    if ( otn1->sigInfo.priority < otn2->sigInfo.priority )
+        return -1;
+
+    if ( otn1->sigInfo.priority > otn2->sigInfo.priority )
+        return +1;
+
+    /* This improves stability of repeated tests */
+    if ( otn1->sigInfo.id < otn2->sigInfo.id )
+        return -1;
+
+    if ( otn1->sigInfo.id > otn2->sigInfo.id )
+        return +1;
+
+    return 0;
+}
+
+// FIXIT-L pattern length is not a valid event sort criterion for
+// non-literals
+static int sortOrderByContentLength(const void* e1, const void* e2)
+{
+    OptTreeNode* otn1;
+    OptTreeNode* otn2;
+
+    if (!e1 || !e2)
+        return 0;
+
+    otn1 = *(OptTreeNode**)e1;
+    otn2 = *(OptTreeNode**)e2;
+
+    if (otn1->longestPatternLen < otn2->longestPatternLen)
+        return +1;
+
+    if (otn1->longestPatternLen > otn2->longestPatternLen)
+        return -1;
+
+    /* This improves stability of repeated tests */
+    if ( otn1->sigInfo.id < otn2->sigInfo.id )
+        return +1;
+
+    if ( otn1->sigInfo.id > otn2->sigInfo.id )
+        return -1;
+
+    return 0;
+}
+
+// true if otn1 should be acted on before otn2 per event_queue.order_events
+static inline bool event_before(const OptTreeNode* otn1, const OptTreeNode* otn2)
+{
+    if ( snort_conf->event_queue_config->order == SNORT_EVENTQ_CONTENT_LEN )
+        return sortOrderByContentLength(&otn1, &otn2) < 0;
+
+    return sortOrderByPriority(&otn1, &otn2) < 0;
+}
+
 /*
 **
 **  NAME
@@ -251,6 +364,10 @@ int fpLogEvent(const RuleTreeNode* rtn, const OptTreeNode* otn, Packet* p)
 **    one.  This function also allows us to change the order of alert,
 **    pass, and log signatures by cacheing them for decision later.
 **
+**    Each queue is kept in event order as matches are added so
+**    fpFinalSelectEvent doesn't have to sort.  When a queue is full,
+**    a new event that ranks ahead of the last one replaces it.
+**
 **    IMPORTANT NOTE:
 **    fpAddMatch must be called even when the queue has been maxed
 **    out.  This is because there are three different queues (alert,
@@ -280,30 +397,51 @@ int fpAddMatch(OTNX_MATCH_DATA* omd_local, int /*pLen*/, const OptTreeNode* otn)
     }
     MATCH_INFO* pmi = &omd_local->matchInfo[evalIndex];
 
+    // don't store the same otn again
+    for ( int i=0; i< pmi->iMatchCount; i++ )
+    {
+        if ( pmi->MatchArray[ i  ] == otn )
+            return 0;
+    }
+
+    int max = (int)snort_conf->fast_pattern_config->get_max_queue_events();
+
+    if ( max > MAX_EVENT_MATCH )
+        max = MAX_EVENT_MATCH;
+
+    int rval = 0;
+
     /*
     **  If we hit the max number of unique events for any rule type alert,
-    **  log or pass, then we don't add it to the list.
+    **  log or pass, then we only keep the new one if it ranks ahead of
+    **  the last one queued.
     */
-    if ( pmi->iMatchCount >= (int)snort_conf->fast_pattern_config->get_max_queue_events() ||
-        pmi->iMatchCount >= MAX_EVENT_MATCH)
+    if ( pmi->iMatchCount >= max )
     {
         pc.match_limit++;
-        return 1;
+
+        if ( !pmi->iMatchCount || !event_before(otn, pmi->MatchArray[pmi->iMatchCount - 1]) )
+            return 1;
+
+        pmi->iMatchCount--;
+        rval = 1;
     }
 
-    // don't store the same otn again
-    for ( int i=0; i< pmi->iMatchCount; i++ )
+    // insert the event in order; queues are short so a linear scan from
+    // the tail beats anything fancier
+    int i = pmi->iMatchCount;
+
+    while ( i > 0 && event_before(otn, pmi->MatchArray[i - 1]) )
     {
-        if ( pmi->MatchArray[ i  ] == otn )
-            return 0;
+        pmi->MatchArray[i] = pmi->MatchArray[i - 1];
+        --i;
     }
 
-    //  add the event to the appropriate list
-    pmi->MatchArray[ pmi->iMatchCount ] = otn;
-
+    pmi->MatchArray[i] = otn;
     pmi->iMatchCount++;
+
     omd_local->have_match = true;
-    return 0;
+    return rval;
 }
 
 /*
@@ -476,62 +614,6 @@ static int rule_tree_match(
     return 0;
 }
 
-static int sortOrderByPriority(const void* e1, const void* e2)
-{
-    OptTreeNode* otn1;
-    OptTreeNode* otn2;
-
-    if (!e1 || !e2)
-        return 0;
-
-    otn1 = *(OptTreeNode**)e1;
-    otn2 = *(OptTreeNode**)e2;
-
-    if ( otn1->sigInfo.priority < otn2->sigInfo.priority )
-        return -1;
-
-    if ( otn1->sigInfo.priority > otn2->sigInfo.priority )
-        return +1;
-
-    /* This improves stability of repeated tests */
-    if ( otn1->sigInfo.id < otn2->sigInfo.id )
-        return -1;
-
-    if ( otn1->sigInfo.id > otn2->sigInfo.id )
-        return +1;
-
-    return 0;
-}
-
-// FIXIT-L pattern length is not a valid event sort criterion for
-// non-literals
-static int sortOrderByContentLength(const void* e1, const void* e2)
-{
-    OptTreeNode* otn1;
-    OptTreeNode* otn2;
-
-    if (!e1 || !e2)
-        return 0;
-
-    otn1 = *(OptTreeNode**)e1;
-    otn2 = *(OptTreeNode**)e2;
-
-    if (otn1->longestPatternLen < otn2->longestPatternLen)
-        return +1;
-
-    if (otn1->longestPatternLen > otn2->longestPatternLen)
-        return -1;
-
-    /* This improves stability of repeated tests */
-    if ( otn1->sigInfo.id < otn2->sigInfo.id )
-        return +1;
-
-    if ( otn1->sigInfo.id > otn2->sigInfo.id )
-        return -1;
-
-    return 0;
-}
-
 /*
 **
 **  NAME
@@ -685,32 +767,12 @@ static inline int fpFinalSelectEvent(OTNX_MATCH_DATA* o, Packet* p)
         if (o->matchInfo[i].iMatchCount)
         {
             /*
-             * We must always sort so if we que 8 and log 3 and they are
-             * all from the same action group we want them sorted so we get
-             * the highest 3 in priority, priority and lenght sort do NOT
-             * take precedence over 'alert drop pass ...' ordering.  If
-             * order is 'drop alert', and we log 3 for drop alertsdo not
-             * get logged.  IF order is 'alert drop', and we log 3 for
-             * alert, than no drops are logged.  So, there should be a
-             * built in drop/sdrop/reject comes before alert/pass/log as
-             * part of the natural ordering....Jan '06..
+             * Events were added to each action group in order (see
+             * fpAddMatch) so if we queue 8 and log 3 and they are all from
+             * the same action group we get the highest 3.  Priority and
+             * length order do NOT take precedence over 'alert drop
+             * pass ...' ordering.
              */
-            /* Sort the rules in this action group */
-            if (eq->order == SNORT_EVENTQ_PRIORITY)
-            {
-                qsort(o->matchInfo[i].MatchArray, o->matchInfo[i].iMatchCount,
-                    sizeof(void*), sortOrderByPriority);
-            }
-            else if (eq->order == SNORT_EVENTQ_CONTENT_LEN)
-            {
-                qsort(o->matchInfo[i].MatchArray, o->matchInfo[i].iMatchCount,
-                    sizeof(void*), sortOrderByContentLength);
-            }
-            else
-            {
-                FatalError("fpdetect: Order function for event queue is invalid.\n");
-            }
-
             /* Process each event in the action (alert,drop,log,...) groups */
             for (j=0; j < o->matchInfo[i].iMatchCount; j++)
             {
@@ -776,52 +838,85 @@ static inline int fpFinalSelectEvent(OTNX_MATCH_DATA* o, Packet* p)
     return 0;
 }
 
-class MpseStash
+void MpseStash::init()
 {
-public:
-    static const unsigned max = 32;
+    unsigned limit = snort_conf->fast_pattern_config->get_queue_limit();
 
-    void init()
-    { count = flushed = 0; }
+    if ( limit != max )
+    {
+        term();
+        max = limit;
 
-    bool push(void* user, void* tree, int index, void* list);
-    bool process(MpseMatch, void*);
+        // keep the set at most half full
+        unsigned size = 2;
 
-private:
-    unsigned count;
-    unsigned flushed;
+        while ( size < 2 * max )
+            size <<= 1;
 
-    struct Node {
-        void* user;
-        void* tree;
-        void* list;
-        int index;
-    } queue[max];
-};
+        mask = size - 1;
+        queue = (Node*)snort_calloc(max, sizeof(*queue));
+        slots = (Slot*)snort_calloc(size, sizeof(*slots));
+    }
 
-static THREAD_LOCAL MpseStash stash;
+    count = flushed = 0;
+    forget();
+}
 
-// uniquely insert into q, should splay elements for performance
-// return true if maxed out to trigger a flush
-bool MpseStash::push(void* user, void* tree, int index, void* list)
+void MpseStash::term()
 {
-    pmqs.tot_inq_inserts++;
+    if ( queue )
+        snort_free(queue);
+
+    if ( slots )
+        snort_free(slots);
+
+    queue = nullptr;
+    slots = nullptr;
+    max = 0;
+}
 
-    for ( int i = (int)(count) - 1; i >= 0; --i )
+// empty the set; gen 0 is never valid so calloc'd slots start out empty
+void MpseStash::forget()
+{
+    if ( !++gen )
     {
-        if ( tree == queue[i].tree )
-            return false;
+        memset(slots, 0, (mask + 1) * sizeof(*slots));
+        gen = 1;
     }
+}
+
+// return true if tree is already queued, else remember it
+bool MpseStash::seen(void* tree)
+{
+    unsigned i = ((uintptr_t)tree >> 4) & mask;
 
-    if ( count < max )
+    while ( slots[i].gen == gen )
     {
-        Node& node = queue[count++];
-        node.user = user;
-        node.tree = tree;
-        node.index = index;
-        node.list = list;
-        pmqs.tot_inq_uinserts++;
+        if ( slots[i].tree == tree )
+            return true;
+
+        i = (i + 1) & mask;
     }
+    slots[i].tree = tree;
+    slots[i].gen = gen;
+    return false;
+}
+
+// uniquely insert into q
+// return true if maxed out to trigger a flush
+bool MpseStash::push(void* user, void* tree, int index, void* list)
+{
+    pmqs.tot_inq_inserts++;
+
+    if ( seen(tree) )
+        return false;
+
+    Node& node = queue[count++];
+    node.user = user;
+    node.tree = tree;
+    node.index = index;
+    node.list = list;
+    pmqs.tot_inq_uinserts++;
 
     if ( count == max )
     {
@@ -832,29 +927,48 @@ bool MpseStash::push(void* user, void* tree, int index, void* list)
     return false;
 }
 
-bool MpseStash::process(MpseMatch match, void* context)
+// ids are assigned as rules are compiled so the order doesn't depend on
+// where the trees happen to be allocated; trees are queued at most once
+// so no two nodes compare equal
+static inline unsigned first_option(const void* tree)
+{
+    const detection_option_tree_root_t* root = (const detection_option_tree_root_t*)tree;
+    return root->num_children ? root->children[0]->id : 0;
+}
+
+static inline unsigned tree_id(const void* tree)
+{
+    return ((const detection_option_tree_root_t*)tree)->id;
+}
+
+void MpseStash::process(MpseMatch match, void* context)
 {
     if ( count > pmqs.max_inq )
         pmqs.max_inq = count;
 
     pmqs.tot_inq_flush += flushed;
+    flushed = 0;
 
-    for ( unsigned i = 0; i < count; ++i )
-    {
-        Node& node = queue[i];
+    std::sort(queue, queue + count,
+        [](const Node& a, const Node& b)
+        {
+            unsigned x = first_option(a.tree);
+            unsigned y = first_option(b.tree);
+            return x < y || (x == y && tree_id(a.tree) < tree_id(b.tree));
+        });
 
-        // process a pattern - case is handled by otn processing
-        int res = match(node.user, node.tree, node.index, context, node.list);
+    unsigned n = count;
 
-        if ( res > 0 )
-        {
-            /* terminate matching */
-            count = 0;
-            return true;
-        }
-    }
+    // matches after a flush start a new batch
     count = 0;
-    return false;
+    forget();
+
+    // process a pattern - case is handled by otn processing
+    for ( unsigned i = 0; i < n; ++i )
+    {
+        Node& node = queue[i];
+        match(node.user, node.tree, node.index, context, node.list);
+    }
 }
 
 // rule_tree_match() could be used instead to bypass the queuing
@@ -862,12 +976,8 @@ static int rule_tree_queue(
     void* user, void* tree, int index, void* context, void* list)
 {
     if ( stash.push(user, tree, index, list) )
-    {
-        if ( stash.process(rule_tree_match, context) )
-        {
-            return 1;
-        }
-    }
+        stash.process(rule_tree_match, context);
+
     return 0;
 }
 
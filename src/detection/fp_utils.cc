@@ -48,7 +48,7 @@ static void finalize_content(OptFpList* ofl)
         return;
 
     if ( pmd->negated )
-        pmd->last_check = (PmdLastCheck*)snort_calloc(
+        pmd->last_check = (PmdLastCheck*)snort_calloc_aligned(alignof(PmdLastCheck),
             ThreadConfig::get_instance_max(), sizeof(*pmd->last_check));
 }
 
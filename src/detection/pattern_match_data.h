@@ -29,10 +29,12 @@
 #include "detection/treenodes.h"
 #include "framework/ips_option.h"  // FIXIT-L not a good dependency
 #include "main/snort_types.h"
+#include "main/thread.h"
 #include "main/thread_config.h"
 #include "utils/util.h"
 
-struct PmdLastCheck
+// per packet thread; see dot_node_state_t
+struct alignas(CACHE_LINE_SIZE) PmdLastCheck
 {
     struct timeval ts;
     uint64_t packet_number;
@@ -79,16 +79,13 @@ SF_EVENTQ* sfeventq_new(int max_nodes, int log_nodes, int event_size)
 
     eq = (SF_EVENTQ*)snort_calloc(sizeof(SF_EVENTQ));
 
-    /* Initialize the memory for the nodes that we are going to use. */
-    eq->node_mem = (SF_EVENTQ_NODE*)snort_calloc(max_nodes, sizeof(SF_EVENTQ_NODE));
-    eq->event_mem = (char*)snort_calloc(max_nodes + 1, event_size);
+    /* Initialize the memory for the events that we are going to use. */
+    eq->event_mem = (char*)snort_calloc(max_nodes, event_size);
 
     eq->max_nodes = max_nodes;
     eq->log_nodes = log_nodes;
     eq->event_size = event_size;
-    eq->cur_nodes = 0;
     eq->cur_events = 0;
-    eq->reserve_event = (char*)(&eq->event_mem[max_nodes * eq->event_size]);
 
     return eq;
 }
@@ -98,37 +95,22 @@ SF_EVENTQ* sfeventq_new(int max_nodes, int log_nodes, int event_size)
 **    sfeventq_event_alloc::
 */
 /**
-**  Allocate the memory for an event to add to the event queue.  This
+**  Get the memory for the next event in the event queue.  This
 **  function is meant to be called first, the event structure filled in,
-**  and then added to the queue.  While you can allocate several times before
-**  adding to the queue, this is not recommended as you may get a NULL ptr
-**  if you allocate more than the max node number.
+**  and then added to the queue.  Allocating again before adding returns
+**  the same memory.
 **
 **  @return  void *
 **
-**  @retval  NULL unable to allocate memory.
+**  @retval  NULL the queue is full.
 **  @retval !NULL ptr to memory.
 */
 void* sfeventq_event_alloc(SF_EVENTQ* eq)
 {
-    void* event;
-
     if (eq->cur_events >= eq->max_nodes)
-    {
-        if (eq->reserve_event == NULL)
-            return NULL;
-
-        event = (void*)eq->reserve_event;
-        eq->reserve_event = NULL;
-
-        return event;
-    }
-
-    event = (void*)(&eq->event_mem[eq->cur_events * eq->event_size]);
-
-    eq->cur_events++;
+        return NULL;
 
-    return event;
+    return (void*)(&eq->event_mem[eq->cur_events * eq->event_size]);
 }
 
 /*
@@ -136,17 +118,13 @@ void* sfeventq_event_alloc(SF_EVENTQ* eq)
 **    sfeventq_reset::
 */
 /**
-**  Resets the event queue.  We also set the reserve event back
-**  to the last event in the queue.
+**  Resets the event queue.
 **
 **  @return void
 */
 void sfeventq_reset(SF_EVENTQ* eq)
 {
-    eq->head = NULL;
-    eq->cur_nodes = 0;
     eq->cur_events = 0;
-    eq->reserve_event = (char*)(&eq->event_mem[eq->max_nodes * eq->event_size]);
 }
 
 /*
@@ -164,13 +142,6 @@ void sfeventq_free(SF_EVENTQ* eq)
     if (eq == NULL)
         return;
 
-    /* Free the memory for the nodes that were in use. */
-    if (eq->node_mem != NULL)
-    {
-        snort_free(eq->node_mem);
-        eq->node_mem = NULL;
-    }
-
     if (eq->event_mem != NULL)
     {
         snort_free(eq->event_mem);
@@ -180,37 +151,6 @@ void sfeventq_free(SF_EVENTQ* eq)
     snort_free(eq);
 }
 
-/*
-**  NAME
-**    get_eventq_node::
-*/
-/**
-**  This function returns a ptr to the node to use.  We allocate the last
-**  event node if we have exhausted the event queue.  Before we allocate
-**  the last node, we determine if the incoming event has a higher
-**  priority than the last node.  If it does, we allocate the node, otherwise
-**  we drop it because it is lower priority.
-**
-**  If the last node is allocated, we have to point the reserve_event to
-**  the allocated event memory, since the reserved_event memory was used
-**  for the incoming event.
-**
-**  @return SF_EVENTQ_NODE *
-**
-**  @retval NULL resource exhaustion and event is lower priority than last node
-**  @retval !NULL ptr to node memory.
-*/
-static SF_EVENTQ_NODE* get_eventq_node(SF_EVENTQ* eq, void*)
-{
-    if (eq->cur_nodes >= eq->max_nodes)
-        return NULL;
-
-    /*
-    **  We grab the next node from the node memory.
-    */
-    return &eq->node_mem[eq->cur_nodes++];
-}
-
 /*
 **  NAME
 **    sfeventq_add:
@@ -228,41 +168,15 @@ static SF_EVENTQ_NODE* get_eventq_node(SF_EVENTQ* eq, void*)
 */
 int sfeventq_add(SF_EVENTQ* eq, void* event)
 {
-    SF_EVENTQ_NODE* node;
-
-    if (!event)
-        return -1;
-
     /*
-    **  If get_eventq_node() returns NULL, this means that
-    **  we have exhausted the eventq and the incoming event
-    **  is lower in priority then the last ranked event.
-    **  So we just drop it.
+    **  Only the event returned by sfeventq_event_alloc()
+    **  can be added.
     */
-    node = get_eventq_node(eq, event);
-    if (!node)
+    if (!event || eq->cur_events >= eq->max_nodes ||
+        event != &eq->event_mem[eq->cur_events * eq->event_size])
         return -1;
 
-    node->event = event;
-    node->next  = NULL;
-    node->prev  = NULL;
-
-    /*
-    **  This is the first node
-    */
-    if (eq->cur_nodes == 1)
-    {
-        eq->head = eq->last = node;
-        return 0;
-    }
-
-    /*
-    **  This means we are the last node.
-    */
-    node->prev = eq->last;
-
-    eq->last->next = node;
-    eq->last = node;
+    eq->cur_events++;
 
     return 0;
 }
@@ -283,24 +197,18 @@ int sfeventq_add(SF_EVENTQ* eq, void* event)
 */
 int sfeventq_action(SF_EVENTQ* eq, int (* action_func)(void*, void*), void* user)
 {
-    SF_EVENTQ_NODE* node;
-    int logged = 0;
-
     if (action_func == NULL)
         return -1;
 
-    if (eq->head == NULL)
+    if (eq->cur_events == 0)
         return 0;
 
-    for (node = eq->head; node != NULL; node = node->next)
-    {
-        if (logged >= eq->log_nodes)
-            return 1;
+    int num = (eq->cur_events < eq->log_nodes) ? eq->cur_events : eq->log_nodes;
 
-        if (action_func(node->event, user))
+    for (int i = 0; i < num; i++)
+    {
+        if (action_func(&eq->event_mem[i * eq->event_size], user))
             return -1;
-
-        logged++;
     }
 
     return 1;
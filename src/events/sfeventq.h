@@ -20,34 +20,14 @@
 #ifndef SFEVENTQ_H
 #define SFEVENTQ_H
 
-typedef struct s_SF_EVENTQ_NODE
-{
-    void* event;
-
-    struct s_SF_EVENTQ_NODE* prev;
-    struct s_SF_EVENTQ_NODE* next;
-}  SF_EVENTQ_NODE;
+// events are stored inline in the order they are added; the caller
+// (fpFinalSelectEvent) adds them already ranked so resetting the queue for
+// the next packet only needs to clear the count.
 
 typedef struct s_SF_EVENTQ
 {
-    /*
-    **  Handles the actual ordering and memory
-    **  of the event queue and it's nodes.
-    */
-    SF_EVENTQ_NODE* head;
-    SF_EVENTQ_NODE* last;
-
-    SF_EVENTQ_NODE* node_mem;
     char* event_mem;
 
-    /*
-    **  The reserve event allows us to allocate one extra node
-    **  and compare against the last event in the queue to determine
-    **  if the incoming event is a higher priority than the last
-    **  event in the queue.
-    */
-    char* reserve_event;
-
     /*
     **  Queue configuration
     */
@@ -57,9 +37,8 @@ typedef struct s_SF_EVENTQ
 
     /*
     **  This element tracks the current number of
-    **  nodes in the event queue.
+    **  events in the event queue.
     */
-    int cur_nodes;
     int cur_events;
 }  SF_EVENTQ;
 
@@ -52,17 +52,22 @@ int64_t FileCapture::capture_block_size = 0;
 
 std::mutex FileCapture::capture_mutex;
 std::condition_variable FileCapture::capture_cv;
-std::thread* FileCapture::file_storer = nullptr;
+std::vector<std::thread*> FileCapture::file_storers;
 std::queue<FileCapture*> FileCapture::files_waiting;
+size_t FileCapture::max_files_waiting = 0;
 bool FileCapture::running = true;
 
+std::atomic<uint64_t> FileCapture::files_queued { 0 };
+std::atomic<uint64_t> FileCapture::files_queue_full { 0 };
+std::atomic<uint64_t> FileCapture::queue_depth_max { 0 };
+
 FileCaptureState FileCapture::error_capture(FileCaptureState state)
 {
     file_counts.file_reserve_failures++;
     return state;
 }
 
-// Only one writer thread supported
+// Multiple writer threads may run this; each takes the next file waiting
 void FileCapture::writer_thread()
 {
     while (1)
@@ -129,11 +134,15 @@ FileCapture::~FileCapture()
         delete file_info;
 }
 
-void FileCapture::init(int64_t memcap, int64_t block_size)
+void FileCapture::init(int64_t memcap, int64_t block_size, int64_t writers,
+    int64_t queue_size)
 {
     capture_block_size = block_size;
+    max_files_waiting = queue_size;
     init_mempool(memcap, capture_block_size);
-    file_storer = new std::thread(writer_thread);
+
+    for ( int64_t i = 0; i < writers; i++ )
+        file_storers.push_back(new std::thread(writer_thread));
 }
 
 /*
@@ -142,15 +151,18 @@ void FileCapture::init(int64_t memcap, int64_t block_size)
  */
 void FileCapture::exit()
 {
-    running = false;
-    capture_cv.notify_one();
+    {
+        std::lock_guard<std::mutex> lk(capture_mutex);
+        running = false;
+    }
+    capture_cv.notify_all();
 
-    if (file_storer)
+    for ( auto storer : file_storers )
     {
-        file_storer->join();
-        delete file_storer;
-        file_storer = nullptr;
+        storer->join();
+        delete storer;
     }
+    file_storers.clear();
 
     if (file_mempool)
     {
@@ -493,16 +505,18 @@ void FileCapture::store_file()
 
     std::string& file_full_name = file_info->get_file_name();
 
-    /*Check whether the file exists*/
-    struct stat buffer;
-    if (stat (file_full_name.c_str(), &buffer) == 0)
+    // Several writers may store files with the same name; create the file
+    // exclusively so only one of them writes it
+    int fd = open(file_full_name.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0644);
+    if (fd < 0)
     {
         return;
     }
 
-    FILE* fh = fopen(file_full_name.c_str(), "w");
+    FILE* fh = fdopen(fd, "w");
     if (!fh )
     {
+        close(fd);
         return;
     }
 
@@ -516,9 +530,7 @@ void FileCapture::store_file()
         file_mem = get_file_data(&buff, &size);
         // Get file from file buffer
         if (!buff || !size )
-        {
-            return;
-        }
+            break;
 
         write_file_data(buff, size, fh);
     }
@@ -544,8 +556,25 @@ void FileCapture::store_file_async()
     get_instance_file(file_full_name, file_name.c_str());
     file_info->set_file_name(file_full_name.c_str(), file_full_name.size());
 
-    std::lock_guard<std::mutex> lk(capture_mutex);
+    std::unique_lock<std::mutex> lk(capture_mutex);
+
+    // don't let a slow disk back up into the packet threads
+    if ( max_files_waiting && files_waiting.size() >= max_files_waiting )
+    {
+        lk.unlock();
+        files_queue_full++;
+        delete this;
+        return;
+    }
+
     files_waiting.push(this);
+
+    if ( files_waiting.size() > queue_depth_max )
+        queue_depth_max = files_waiting.size();
+
+    lk.unlock();
+
+    files_queued++;
     capture_cv.notify_one();
 }
 
@@ -558,6 +587,9 @@ void FileCapture::print_mem_usage()
         LogCount("Buffers in use", file_mempool->allocated());
         LogCount("Buffers in free list", file_mempool->freed());
         LogCount("Buffers in release list", file_mempool->released());
+        LogCount("Files queued for storing", files_queued);
+        LogCount("Files dropped, queue full", files_queue_full);
+        LogCount("Max files waiting", queue_depth_max);
     }
 }
 
@@ -31,10 +31,12 @@
 // 3) Then file data can be read through file_capture_read()
 // 4) Finally, fila data must be released from mempool file_capture_release()
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 #include <queue>
 #include <thread>
+#include <vector>
 
 #include "file_api.h"
 
@@ -54,7 +56,8 @@ public:
     ~FileCapture();
 
     // this must be called during snort init
-    static void init(int64_t memcap, int64_t block_size);
+    static void init(int64_t memcap, int64_t block_size, int64_t writers = 1,
+        int64_t queue_size = 0);
 
     // Capture file data to local buffer
     // This is the main function call to enable file capture
@@ -81,7 +84,8 @@ public:
     // Store files on local disk
     void store_file();
 
-    // Store file to disk asynchronously
+    // Store file to disk asynchronously; the file is deleted by the writer
+    // thread once stored, or right away if the store queue is full
     void store_file_async();
 
     // Log file capture mempoofile_contentl usage
@@ -108,10 +112,16 @@ private:
     static int64_t capture_block_size;
     static std::mutex capture_mutex;
     static std::condition_variable capture_cv;
-    static std::thread* file_storer;
+    static std::vector<std::thread*> file_storers;
     static std::queue<FileCapture*> files_waiting;
+    static size_t max_files_waiting;
     static bool running;
 
+    // shared by all threads, see print_mem_usage()
+    static std::atomic<uint64_t> files_queued;
+    static std::atomic<uint64_t> files_queue_full;
+    static std::atomic<uint64_t> queue_depth_max;
+
     bool reserved;
     uint64_t capture_size;
     FileCaptureBlock* last;  /* last block of file data */
@@ -36,6 +36,8 @@
 #define DEFAULT_FILE_CAPTURE_MAX_SIZE       1048576     // 1 MiB
 #define DEFAULT_FILE_CAPTURE_MIN_SIZE       0           // 0
 #define DEFAULT_FILE_CAPTURE_BLOCK_SIZE     32768       // 32 KiB
+#define DEFAULT_FILE_CAPTURE_WRITERS        1
+#define DEFAULT_FILE_CAPTURE_QUEUE_SIZE     1024
 #define DEFAULT_MAX_FILES_CACHED            65536
 
 #define FILE_ID_NAME "file_id"
@@ -46,6 +48,7 @@ class FileConfig
 public:
     FileMagicRule* get_rule_from_id(uint32_t);
     void process_file_rule(FileMagicRule&);
+    void compile_file_rules();
     void process_file_policy_rule(FileRule&);
     bool process_file_magic(FileMagicData&);
     uint32_t find_file_type_id(const uint8_t* buf, int len, uint64_t file_offset, void** context);
@@ -61,6 +64,8 @@ public:
     int64_t capture_max_size = DEFAULT_FILE_CAPTURE_MAX_SIZE;
     int64_t capture_min_size = DEFAULT_FILE_CAPTURE_MIN_SIZE;
     int64_t capture_block_size = DEFAULT_FILE_CAPTURE_BLOCK_SIZE;
+    int64_t capture_writers = DEFAULT_FILE_CAPTURE_WRITERS;
+    int64_t capture_queue_size = DEFAULT_FILE_CAPTURE_QUEUE_SIZE;
     int64_t file_depth =  0;
     int64_t max_files_cached = DEFAULT_MAX_FILES_CACHED;
 
@@ -244,8 +244,18 @@ FilePosition get_file_position(Packet* pkt)
 
 FileInspect::FileInspect(FileIdModule* fm)
 {
-    fm->fc.get_file_policy().load();
-    config = &(fm->fc);
+    config = fm->get_config();
+
+    if ( !config )
+        config = new FileConfig;
+
+    config->get_file_policy().load();
+    config->compile_file_rules();
+}
+
+FileInspect::~FileInspect()
+{
+    delete config;
 }
 
 static Module* mod_ctor()
@@ -32,6 +32,7 @@
 #include <assert.h>
 
 #include <algorithm>
+#include <unordered_map>
 
 #include "log/messages.h"
 #include "utils/util.h"
@@ -40,6 +41,9 @@
 #include "catch/catch.hpp"
 #endif
 
+// nodes with more distinct transitions than this get a dense table
+#define MAX_SPARSE_EDGES 8
+
 struct MergeNode
 {
     IdentifierNode* shared_node;  /*the node that is shared*/
@@ -75,16 +79,24 @@ void FileIdentifier::init_merge_hash()
 }
 
 FileIdentifier::~FileIdentifier()
+{
+    release_build_trie();
+}
+
+void FileIdentifier::release_build_trie()
 {
     /*Release memory used for identifiers*/
     for (auto mem_block:id_memory_blocks)
     {
         snort_free(mem_block);
     }
+    id_memory_blocks.clear();
+    identifier_root = nullptr;
 
     if (identifier_merge_hash != nullptr)
     {
         sfghash_delete(identifier_merge_hash);
+        identifier_merge_hash = nullptr;
     }
 }
 
@@ -298,6 +310,13 @@ void FileIdentifier::insert_file_rule(FileMagicRule& rule)
 {
     IdentifierNode* node;
 
+    /*rules can't be added once the trie is compiled*/
+    if (!nodes.empty())
+    {
+        ParseError("file type: rule id %u added after file rules were compiled", rule.id);
+        return;
+    }
+
     if (!identifier_root)
     {
         identifier_root = (IdentifierNode*)calloc_mem(sizeof(*identifier_root));
@@ -322,6 +341,135 @@ void FileIdentifier::insert_file_rule(FileMagicRule& rule)
     update_trie(identifier_root, node);
 }
 
+/*
+ * Flatten the build trie into the compiled node array. Shared subtries
+ * stay shared since each build node is emitted only once.
+ */
+void FileIdentifier::compile()
+{
+    /*nothing new since the last compile; lookups may be using the nodes*/
+    if (!identifier_root)
+        return;
+
+    nodes.clear();
+    edge_bytes.clear();
+    edge_next.clear();
+
+    std::unordered_map<const IdentifierNode*, uint32_t> node_index;
+    std::vector<const IdentifierNode*> build_nodes;
+
+    auto get_index = [&](const IdentifierNode* n) -> uint32_t
+        {
+            if (!n)
+                return FILE_MAGIC_NO_NODE;
+
+            auto it = node_index.find(n);
+
+            if (it != node_index.end())
+                return it->second;
+
+            uint32_t idx = build_nodes.size();
+            node_index[n] = idx;
+            build_nodes.push_back(n);
+            return idx;
+        };
+
+    get_index(identifier_root);
+
+    /*build_nodes grows as new children are found, breadth first*/
+    for (unsigned i = 0; i < build_nodes.size(); i++)
+    {
+        const IdentifierNode* start = build_nodes[i];
+        uint32_t next[MAX_BRANCH];
+        std::unordered_map<uint32_t, unsigned> counts;
+
+        for (int index = 0; index < MAX_BRANCH; index++)
+        {
+            next[index] = get_index(start->next[index]);
+            counts[next[index]]++;
+        }
+
+        /*the most common transition becomes the default one*/
+        FileMagicNode node;
+        node.type_id = start->type_id;
+        node.offset = start->offset;
+        node.any_next = FILE_MAGIC_NO_NODE;
+        unsigned max_count = 0;
+
+        for (auto& c : counts)
+        {
+            if (c.second > max_count)
+            {
+                max_count = c.second;
+                node.any_next = c.first;
+            }
+        }
+
+        unsigned num_edges = MAX_BRANCH - max_count;
+
+        if (num_edges > MAX_SPARSE_EDGES)
+        {
+            node.any_next = FILE_MAGIC_NO_NODE;
+            node.num_edges = MAX_BRANCH;
+            node.edges = edge_next.size();
+            edge_next.insert(edge_next.end(), next, next + MAX_BRANCH);
+            /*keep edge_bytes in step with edge_next*/
+            edge_bytes.resize(edge_next.size());
+        }
+        else
+        {
+            node.num_edges = num_edges;
+            node.edges = edge_next.size();
+
+            /*edges are sorted by byte value*/
+            for (int index = 0; index < MAX_BRANCH; index++)
+            {
+                if (next[index] != node.any_next)
+                {
+                    edge_bytes.push_back((uint8_t)index);
+                    edge_next.push_back(next[index]);
+                }
+            }
+        }
+        nodes.push_back(node);
+    }
+
+    release_build_trie();
+
+    memory_used = nodes.size() * sizeof(FileMagicNode) +
+        edge_bytes.size() * sizeof(uint8_t) + edge_next.size() * sizeof(uint32_t);
+}
+
+inline const FileMagicNode* FileIdentifier::get_next(const FileMagicNode* node,
+    uint8_t value) const
+{
+    uint32_t next;
+
+    if (node->num_edges == MAX_BRANCH)
+        next = edge_next[node->edges + value];
+
+    else
+    {
+        next = node->any_next;
+
+        for (unsigned i = node->edges; i < node->edges + node->num_edges; i++)
+        {
+            if (edge_bytes[i] < value)
+                continue;
+
+            if (edge_bytes[i] == value)
+                next = edge_next[i];
+
+            break;
+        }
+    }
+
+    if (next == FILE_MAGIC_NO_NODE)
+        return nullptr;
+
+    return &nodes[next];
+}
+
 /*
  * This is the main function to find file type
  * Find file type is to traverse the tries.
@@ -337,10 +485,13 @@ uint32_t FileIdentifier::find_file_type_id(const uint8_t* buf, int len, uint64_t
     if ( !buf || len <= 0 )
         return SNORT_FILE_TYPE_CONTINUE;
 
+    if ( nodes.empty() )
+        return SNORT_FILE_TYPE_UNKNOWN;
+
     if (!(*context))
-        *context = (void*)(identifier_root);
+        *context = (void*)(&nodes[0]);
 
-    IdentifierNode* current = (IdentifierNode*)(*context);
+    const FileMagicNode* current = (const FileMagicNode*)(*context);
 
     uint64_t end = file_offset + len;
 
@@ -355,7 +506,7 @@ uint32_t FileIdentifier::find_file_type_id(const uint8_t* buf, int len, uint64_t
         if ( current->offset >= end )
         {
             /* Save current state */
-            *context = current;
+            *context = (void*)current;
             if (file_type_id)
                 return file_type_id;
             else
@@ -363,7 +514,7 @@ uint32_t FileIdentifier::find_file_type_id(const uint8_t* buf, int len, uint64_t
         }
 
         /*Move to the next level*/
-        current = current->next[buf[current->offset - file_offset ]];
+        current = get_next(current, buf[current->offset - file_offset]);
     }
 
     /*Either end of magics or passed the current offset*/
@@ -413,6 +564,7 @@ TEST_CASE ("FileIdRulePDF", "[FileMagic]")
     FileIdentifier rc;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDF";
 
@@ -437,6 +589,7 @@ TEST_CASE ("FileIdRuleUnknow", "[FileMagic]")
     FileIdentifier rc;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "DDF";
 
@@ -472,6 +625,7 @@ TEST_CASE ("FileIdRuleEXE", "[FileMagic]")
     rule.id = 3;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDFooo";
     void* context = nullptr;
@@ -505,6 +659,7 @@ TEST_CASE ("FileIdRulePDFEXE", "[FileMagic]")
     rule.id = 3;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDFEXE";
     void* context = nullptr;
@@ -539,11 +694,56 @@ TEST_CASE ("FileIdRuleFirst", "[FileMagic]")
     rule.id = 3;
 
     rc.insert_file_rule(rule);
+    rc.compile();
 
     const char* data = "PDF";
     void* context = nullptr;
 
     CHECK(rc.find_file_type_id((const uint8_t*)data, strlen(data), 0, &context) == 1);
 }
-#endif
 
+TEST_CASE ("FileIdCompiledMemory", "[FileMagic]")
+{
+    FileIdentifier rc;
+    FileMagicData magic;
+    FileMagicRule rule;
+
+    magic.content = "PDF";
+    magic.offset = 0;
+    rule.file_magics.push_back(magic);
+    rule.id = 1;
+    rc.insert_file_rule(rule);
+
+    magic.clear();
+    magic.content = "ZIP";
+    magic.offset = 4;
+    rule.clear();
+    rule.file_magics.push_back(magic);
+    rule.id = 2;
+    rc.insert_file_rule(rule);
+
+    uint32_t build_memory = rc.memory_usage();
+    rc.compile();
+
+    CHECK(rc.memory_usage() > 0);
+    CHECK(rc.memory_usage() < build_memory);
+
+    // gap between offset 0 and 4 is any byte
+    const char* data = "xxxxZIP";
+    void* context = nullptr;
+    CHECK(rc.find_file_type_id((const uint8_t*)data, strlen(data), 0, &context) == 2);
+
+    // same data split across two calls
+    context = nullptr;
+    CHECK(rc.find_file_type_id((const uint8_t*)data, 5, 0, &context) ==
+        SNORT_FILE_TYPE_CONTINUE);
+    CHECK(rc.find_file_type_id((const uint8_t*)data + 5, 2, 5, &context) == 2);
+
+    // compiling again leaves the trie in use intact
+    context = nullptr;
+    CHECK(rc.find_file_type_id((const uint8_t*)data, 5, 0, &context) ==
+        SNORT_FILE_TYPE_CONTINUE);
+    rc.compile();
+    CHECK(rc.find_file_type_id((const uint8_t*)data + 5, 2, 5, &context) == 2);
+}
+#endif
@@ -25,6 +25,12 @@
 // File type identification is based on file magic. To improve the detection
 // performance, a trie is created to scan file data once. Currently, only the
 // most specific file type is returned.
+//
+// The trie built from the rules uses 256 pointers per node, which is
+// convenient for merging magics but large and cache unfriendly. Once all
+// rules are inserted, compile() flattens it into a read only array of
+// nodes with compact edge lists that is used for lookups; the build trie
+// is released at that point.
 
 #include <list>
 #include <vector>
@@ -82,11 +88,29 @@ struct IdentifierNode
 
 typedef std::list<void* >  IDMemoryBlocks;
 
+// compiled trie node; nodes with many distinct transitions get a dense
+// 256 entry table, the others a short list of (byte, next) edges scanned
+// linearly. gap nodes (all bytes go the same way) use any_next.
+struct FileMagicNode
+{
+    uint32_t type_id;
+    uint32_t offset;
+    uint32_t any_next;   // transition for bytes without an edge
+    uint32_t edges;      // index into edge_bytes / edge_next
+    uint16_t num_edges;  // MAX_BRANCH means dense table
+};
+
+#define FILE_MAGIC_NO_NODE UINT32_MAX
+
 class FileIdentifier
 {
 public: ~FileIdentifier();
     uint32_t memory_usage() { return memory_used; }
     void insert_file_rule(FileMagicRule& rule);
+
+    // must be called after the last insert_file_rule() and before lookups
+    void compile();
+
     uint32_t find_file_type_id(const uint8_t* buf, int len, uint64_t offset, void** context);
     FileMagicRule* get_rule_from_id(uint32_t);
 
@@ -99,6 +123,8 @@ private:
     bool update_next(IdentifierNode* start, IdentifierNode** next_ptr, IdentifierNode* append);
     IdentifierNode* create_trie_from_magic(FileMagicRule& rule, uint32_t type_id);
     void update_trie(IdentifierNode* start, IdentifierNode* append);
+    void release_build_trie();
+    inline const FileMagicNode* get_next(const FileMagicNode*, uint8_t) const;
 
     /*properties*/
     IdentifierNode* identifier_root = nullptr; /*Root of magic tries*/
@@ -106,6 +132,11 @@ private:
     SFGHASH* identifier_merge_hash = nullptr;
     FileMagicRule file_magic_rules[FILE_ID_MAX + 1];
     IDMemoryBlocks id_memory_blocks;
+
+    /*compiled trie, root is node 0*/
+    std::vector<FileMagicNode> nodes;
+    std::vector<uint8_t> edge_bytes;
+    std::vector<uint32_t> edge_next;
 };
 
 #endif
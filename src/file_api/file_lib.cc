@@ -36,6 +36,7 @@
 #include "framework/data_bus.h"
 #include "main/snort_config.h"
 #include "managers/inspector_manager.h"
+#include "memory/memory_cap.h"
 #include "utils/util.h"
 
 #include "file_capture.h"
@@ -178,7 +179,7 @@ FileContext::FileContext ()
 FileContext::~FileContext ()
 {
     if (file_signature_context)
-        snort_free(file_signature_context);
+        delete file_signature_context;
     if (file_capture)
         stop_file_capture();
     if (file_segments)
@@ -203,6 +204,8 @@ inline int FileContext::get_data_size_from_depth_limit(FileProcessType type, int
         return data_size;
     }
 
+    max_depth = memory::MemoryCap::limit_depth((int64_t)max_depth);
+
     if (processed_bytes > max_depth)
         data_size = -1;
     else if (processed_bytes + data_size > max_depth)
@@ -422,30 +425,33 @@ void FileContext::process_file_signature_sha256(const uint8_t* file_data, int si
     {
     case SNORT_FILE_START:
         if (!file_signature_context)
-            file_signature_context = snort_calloc(sizeof(SHA256_CTX));
-        SHA256_Init((SHA256_CTX*)file_signature_context);
-        SHA256_Update((SHA256_CTX*)file_signature_context, file_data, data_size);
+            file_signature_context = new Sha256;
+        if (!file_signature_context->init())
+            return;
+        file_signature_context->update(file_data, data_size);
         break;
     case SNORT_FILE_MIDDLE:
         if (!file_signature_context)
             return;
-        SHA256_Update((SHA256_CTX*)file_signature_context, file_data, data_size);
+        file_signature_context->update(file_data, data_size);
         break;
     case SNORT_FILE_END:
         if (!file_signature_context)
             return;
-        SHA256_Update((SHA256_CTX*)file_signature_context, file_data, data_size);
+        file_signature_context->update(file_data, data_size);
         sha256 = new uint8_t[SHA256_HASH_SIZE];
-        SHA256_Final(sha256, (SHA256_CTX*)file_signature_context);
+        if (!file_signature_context->final(sha256))
+        {
+            delete[] sha256;
+            sha256 = nullptr;
+            return;
+        }
         file_state.sig_state = FILE_SIG_DONE;
         break;
     case SNORT_FILE_FULL:
-        if (!file_signature_context)
-            file_signature_context = snort_calloc(sizeof (SHA256_CTX));
-        SHA256_Init((SHA256_CTX*)file_signature_context);
-        SHA256_Update((SHA256_CTX*)file_signature_context, file_data, data_size);
+        // whole file in one piece, no context needed
         sha256 = new uint8_t[SHA256_HASH_SIZE];
-        SHA256_Final(sha256, (SHA256_CTX*)file_signature_context);
+        ::sha256(file_data, data_size, sha256);
         file_state.sig_state = FILE_SIG_DONE;
         break;
     default:
@@ -37,6 +37,7 @@ class FileConfig;
 class FileSegments;
 class Flow;
 class FileInspect;
+class Sha256;
 
 class SO_PUBLIC FileInfo
 {
@@ -124,7 +125,7 @@ private:
     bool file_capture_enabled = false;
     uint64_t processed_bytes = 0;
     void* file_type_context;
-    void* file_signature_context;
+    Sha256* file_signature_context;
     FileConfig* file_config;
     FileInspect* inspector;
     FileCapture* file_capture;
@@ -36,6 +36,7 @@ class FileIdModule : public Module
 {
 public:
     FileIdModule();
+    ~FileIdModule();
 
     bool set(const char*, Value&, SnortConfig*) override;
     bool begin(const char*, int, SnortConfig*) override;
@@ -46,9 +47,11 @@ public:
 
     void sum_stats() override;
 
-    FileConfig fc;
+    // each configuration load gets its own instance, owned by the inspector
+    FileConfig* get_config();
 
 private:
+    FileConfig* fc = nullptr;
     FileMagicRule rule;
     FileMagicData magic;
     FileRule file_rule;
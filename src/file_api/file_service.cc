@@ -59,7 +59,8 @@ void FileService::post_init()
         return;
 
     if (file_capture_enabled)
-        FileCapture::init(conf->capture_memcap, conf->capture_block_size);
+        FileCapture::init(conf->capture_memcap, conf->capture_block_size,
+            conf->capture_writers, conf->capture_queue_size);
 }
 
 void FileService::close()
@@ -0,0 +1,92 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// filter_hash.cc
+
+#include "filter_hash.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "hash/sfxhash.h"
+
+FilterHash::FilterHash(unsigned nbytes, size_t key, size_t data)
+{
+    size_t size = key + data;
+    key_size = key;
+
+    // split the memcap across the shards but give each at least one node
+    nbytes /= FILTER_HASH_SHARDS;
+
+    if ( nbytes < size )
+        nbytes = size;
+
+    int nrows = nbytes / size;
+
+    for ( auto& s : shards )
+    {
+        s.table = sfxhash_new(
+            nrows,  /* try one node per row - for speed */
+            key,    /* keys size */
+            data,   /* data size */
+            nbytes, /* memcap **/
+            1,      /* ANR flag - true ?- Automatic Node Recovery=ANR */
+            0,      /* ANR callback - none */
+            0,      /* user freemem callback - none */
+            1);     /* Recycle nodes ?*/
+
+        if ( !s.table )
+            break;
+    }
+}
+
+FilterHash::~FilterHash()
+{
+    for ( auto& s : shards )
+    {
+        if ( s.table )
+            sfxhash_delete(s.table);
+    }
+}
+
+// FNV-1a; sfxhash rows use their own seeded hash so the shard index
+// doesn't correlate with the row index within the shard
+unsigned FilterHash::get_shard(const void* key) const
+{
+    const uint8_t* k = (const uint8_t*)key;
+    uint32_t h = 2166136261u;
+
+    for ( size_t i = 0; i < key_size; ++i )
+    {
+        h ^= k[i];
+        h *= 16777619u;
+    }
+    return (h ^ (h >> 16)) % FILTER_HASH_SHARDS;
+}
+
+void FilterHash::make_empty()
+{
+    for ( auto& s : shards )
+    {
+        std::lock_guard<std::mutex> lock(s.lock);
+
+        if ( s.table )
+            sfxhash_make_empty(s.table);
+    }
+}
+
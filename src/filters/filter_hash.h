@@ -0,0 +1,72 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// filter_hash.h
+
+#ifndef FILTER_HASH_H
+#define FILTER_HASH_H
+
+// FilterHash holds the dynamic state of event and rate filters, which is
+// shared by all packet threads so that by_src / by_dst counts are global.
+// Keys are spread across a fixed number of SFXHASH shards, each with its
+// own lock, so threads only contend when they update the same shard.  The
+// memcap is split evenly across the shards.
+
+#include <mutex>
+
+struct SFXHASH;
+
+#define FILTER_HASH_SHARDS 16
+
+class FilterHash
+{
+public:
+    FilterHash(unsigned nbytes, size_t key_size, size_t data_size);
+    ~FilterHash();
+
+    FilterHash(const FilterHash&) = delete;
+    FilterHash& operator=(const FilterHash&) = delete;
+
+    // false if any shard could not be allocated
+    bool ok() const
+    { return shards[FILTER_HASH_SHARDS - 1].table != nullptr; }
+
+    unsigned get_shard(const void* key) const;
+
+    // callers must hold the shard lock while using the table or
+    // any data returned by it
+    std::mutex& get_lock(unsigned shard)
+    { return shards[shard].lock; }
+
+    SFXHASH* get_table(unsigned shard)
+    { return shards[shard].table; }
+
+    void make_empty();
+
+private:
+    struct Shard
+    {
+        std::mutex lock;
+        SFXHASH* table = nullptr;
+    };
+
+    Shard shards[FILTER_HASH_SHARDS];
+    size_t key_size;
+};
+
+#endif
+
@@ -35,6 +35,8 @@
 #include "utils/sflsq.h"
 #include "utils/util.h"
 
+#include "filter_hash.h"
+
 // Number of hash rows for gid 1 (rules)
 #define SFRF_GEN_ID_1_ROWS 4096
 // Number of hash rows for non-zero gid
@@ -93,7 +95,8 @@ typedef struct
     time_t revertTime;
 } tSFRFTrackingNode;
 
-SFXHASH* rf_hash = NULL;
+// shared by all packet threads
+FilterHash* rf_hash = NULL;
 
 // private methods ...
 static int _checkThreshold(
@@ -109,8 +112,8 @@ static int _checkSamplingPeriod(
     );
 
 static tSFRFTrackingNode* _getSFRFTrackingNode(
-    const SfIp*,
-    unsigned tid,
+    SFXHASH*,
+    const tSFRFTrackingNodeKey*,
     time_t curTime
     );
 
@@ -132,29 +135,17 @@ static void _updateDependentThresholds(
  * @param nbytes maximum memory to use for thresholding objects, in bytes.
  * @return  pointer to newly created tSFRFContext
 */
-#define SFRF_BYTES (sizeof(tSFRFTrackingNodeKey) + sizeof(tSFRFTrackingNode))
-
 static void SFRF_New(unsigned nbytes)
 {
-    int nrows;
+    /* Create global hash table for all of the IP Nodes */
+    rf_hash = new FilterHash(
+        nbytes, sizeof(tSFRFTrackingNodeKey), sizeof(tSFRFTrackingNode));
 
-    /* Calc max ip nodes for this memory */
-    if ( nbytes < SFRF_BYTES )
+    if ( !rf_hash->ok() )
     {
-        nbytes = SFRF_BYTES;
+        delete rf_hash;
+        rf_hash = NULL;
     }
-    nrows = nbytes / (SFRF_BYTES);
-
-    /* Create global hash table for all of the IP Nodes */
-    rf_hash = sfxhash_new(
-        nrows,  /* try one node per row - for speed */
-        sizeof(tSFRFTrackingNodeKey), /* keys size */
-        sizeof(tSFRFTrackingNode),     /* data size */
-        nbytes,                  /* memcap **/
-        1,         /* ANR flag - true ?- Automatic Node Recovery=ANR */
-        0,         /* ANR callback - none */
-        0,         /* user freemem callback - none */
-        1);       /* Recycle nodes ?*/
 }
 
 void SFRF_Delete()
@@ -162,14 +153,14 @@ void SFRF_Delete()
     if ( !rf_hash )
         return;
 
-    sfxhash_delete(rf_hash);
+    delete rf_hash;
     rf_hash = NULL;
 }
 
 void SFRF_Flush()
 {
     if ( rf_hash )
-        sfxhash_make_empty(rf_hash);
+        rf_hash->make_empty();
 }
 
 static void SFRF_ConfigNodeFree(void* item)
@@ -359,9 +350,21 @@ static int SFRF_TestObject(
     )
 {
     tSFRFTrackingNode* dynNode;
+    tSFRFTrackingNodeKey key;
     int retValue = -1;
 
-    dynNode = _getSFRFTrackingNode(ip, cfgNode->tid, curTime);
+    /* Setup key */
+    key.ip = *(ip);
+    key.tid = cfgNode->tid;
+    key.policyId = get_network_policy()->policy_id;
+    key.padding = 0;
+
+    // the node is shared with other packet threads so hold the
+    // shard lock until we are done with it
+    unsigned shard = rf_hash->get_shard(&key);
+    std::lock_guard<std::mutex> lock(rf_hash->get_lock(shard));
+
+    dynNode = _getSFRFTrackingNode(rf_hash->get_table(shard), &key, curTime);
 
     if ( dynNode == NULL )
         return retValue;
@@ -778,24 +781,17 @@ static void _updateDependentThresholds(
 }
 
 static tSFRFTrackingNode* _getSFRFTrackingNode(
-    const SfIp* ip,
-    unsigned tid,
+    SFXHASH* table,
+    const tSFRFTrackingNodeKey* key,
     time_t curTime
     )
 {
     tSFRFTrackingNode* dynNode = NULL;
-    tSFRFTrackingNodeKey key;
-
-    /* Setup key */
-    key.ip = *(ip);
-    key.tid = tid;
-    key.policyId = get_network_policy()->policy_id;
-    key.padding = 0;
 
     /*
      * Check for any Permanent sid objects for this gid or add this one ...
      */
-    SFXHASH_NODE* hnode = sfxhash_get_node(rf_hash, (void*)&key);
+    SFXHASH_NODE* hnode = sfxhash_get_node(table, key);
     if ( hnode && hnode->data )
     {
         dynNode = (tSFRFTrackingNode*)hnode->data;
@@ -40,6 +40,8 @@
 #include "utils/sflsq.h"
 #include "utils/util.h"
 
+#include "filter_hash.h"
+
 //  Debug Printing
 //#define THD_DEBUG
 
@@ -95,21 +97,6 @@ SFXHASH* sfthd_local_new(unsigned bytes)
     return local_hash;
 }
 
-SFXHASH* sfthd_global_new(unsigned bytes)
-{
-    SFXHASH* global_hash =
-        sfthd_new_hash(bytes,
-        sizeof(THD_IP_GNODE_KEY),
-        sizeof(THD_IP_NODE));
-
-#ifdef THD_DEBUG
-    if (global_hash == NULL)
-        printf("Could not allocate the sfxhash table\n");
-#endif
-
-    return global_hash;
-}
-
 THD_STRUCT* sfthd_new(unsigned lbytes, unsigned gbytes)
 {
     THD_STRUCT* thd;
@@ -119,12 +106,13 @@ THD_STRUCT* sfthd_new(unsigned lbytes, unsigned gbytes)
 
 #ifndef CRIPPLE
     /* Create hash table for all of the local IP Nodes */
-    thd->ip_nodes = sfthd_local_new(lbytes);
-    if ( !thd->ip_nodes )
+    thd->ip_nodes = new FilterHash(lbytes, sizeof(THD_IP_NODE_KEY), sizeof(THD_IP_NODE));
+    if ( !thd->ip_nodes->ok() )
     {
 #ifdef THD_DEBUG
         printf("Could not allocate the sfxhash table\n");
 #endif
+        delete thd->ip_nodes;
         snort_free(thd);
         return NULL;
     }
@@ -133,13 +121,14 @@ THD_STRUCT* sfthd_new(unsigned lbytes, unsigned gbytes)
         return thd;
 
     /* Create hash table for all of the global IP Nodes */
-    thd->ip_gnodes = sfthd_global_new(gbytes);
-    if ( !thd->ip_gnodes )
+    thd->ip_gnodes = new FilterHash(gbytes, sizeof(THD_IP_GNODE_KEY), sizeof(THD_IP_NODE));
+    if ( !thd->ip_gnodes->ok() )
     {
 #ifdef THD_DEBUG
         printf("Could not allocate the sfxhash table\n");
 #endif
-        sfxhash_delete(thd->ip_nodes);
+        delete thd->ip_gnodes;
+        delete thd->ip_nodes;
         snort_free(thd);
         return NULL;
     }
@@ -236,16 +225,26 @@ void sfthd_free(THD_STRUCT* thd)
         return;
 
 #ifndef CRIPPLE
-    if (thd->ip_nodes != NULL)
-        sfxhash_delete(thd->ip_nodes);
-
-    if (thd->ip_gnodes != NULL)
-        sfxhash_delete(thd->ip_gnodes);
+    delete thd->ip_nodes;
+    delete thd->ip_gnodes;
 #endif
 
     snort_free(thd);
 }
 
+/* empty out active entries */
+void sfthd_reset_active(THD_STRUCT* thd)
+{
+    if (thd == NULL)
+        return;
+
+    if (thd->ip_nodes != NULL)
+        thd->ip_nodes->make_empty();
+
+    if (thd->ip_gnodes != NULL)
+        thd->ip_gnodes->make_empty();
+}
+
 void* sfthd_create_rule_threshold(int id,
     int tracking,
     int type,
@@ -834,6 +833,64 @@ static inline int sfthd_test_non_suppress(
     return 0;  /* should not get here, so log it just to be safe */
 }
 
+/*
+ *  Find/Add the ip node for key and test it against the threshold object
+ */
+static inline int sfthd_test_ip_node(
+    SFXHASH* hash,
+    void* key,
+    THD_NODE* sfthd_node,
+    time_t curtime)
+{
+    THD_IP_NODE data,* sfthd_ip_node;
+
+    /* Set up a new data element */
+    data.count  = 1;
+    data.prev   = 0;
+    data.tstart = data.tlast = curtime; /* Event time */
+
+    /*
+     * Check for any Permanent sig_id objects for this gen_id  or add this one ...
+     */
+    int status = sfxhash_add(hash, key, &data);
+    if (status == SFXHASH_INTABLE)
+    {
+        /* Already in the table */
+        sfthd_ip_node = (THD_IP_NODE*)hash->cnode->data;
+
+        /* Increment the event count */
+        sfthd_ip_node->count++;
+    }
+    else if (status != SFXHASH_OK)
+    {
+        /* hash error */
+        return 1; /*  check the next threshold object */
+    }
+    else
+    {
+        /* Was not in the table - it was added - work with our copy of the data */
+        sfthd_ip_node = &data;
+    }
+
+    return sfthd_test_non_suppress(sfthd_node, sfthd_ip_node, curtime);
+}
+
+/*
+ *  The shared tables are locked by shard for the duration of the test
+ *  so the node can't be updated or recycled by another packet thread.
+ */
+static inline int sfthd_test_ip_node(
+    FilterHash* hash,
+    void* key,
+    THD_NODE* sfthd_node,
+    time_t curtime)
+{
+    unsigned shard = hash->get_shard(key);
+    std::lock_guard<std::mutex> lock(hash->get_lock(shard));
+
+    return sfthd_test_ip_node(hash->get_table(shard), key, sfthd_node, curtime);
+}
+
 /*!
  *
  *  Find/Test/Add an event against a single threshold object.
@@ -851,16 +908,15 @@ static inline int sfthd_test_non_suppress(
  *  @retval  <0 : Event should never be logged to this user! Suppressed Event+IP
  *
  */
-int sfthd_test_local(
-    SFXHASH* local_hash,
+template<typename Table>
+static inline int sfthd_test_local_node(
+    Table* local_hash,
     THD_NODE* sfthd_node,
     const SfIp* sip,
     const SfIp* dip,
     time_t curtime)
 {
     THD_IP_NODE_KEY key;
-    THD_IP_NODE data,* sfthd_ip_node;
-    int status=0;
     const SfIp* ip;
 
     PolicyId policy_id = get_network_policy()->policy_id;
@@ -912,42 +968,24 @@ int sfthd_test_local(
     key.thd_id = sfthd_node->thd_id;
     key.padding = 0;
 
-    /* Set up a new data element */
-    data.count  = 1;
-    data.prev   = 0;
-    data.tstart = data.tlast = curtime; /* Event time */
-
-    /*
-     * Check for any Permanent sig_id objects for this gen_id  or add this one ...
-     */
-    status = sfxhash_add(local_hash, (void*)&key, &data);
-    if (status == SFXHASH_INTABLE)
-    {
-        /* Already in the table */
-        sfthd_ip_node = (THD_IP_NODE*)local_hash->cnode->data;
-
-        /* Increment the event count */
-        sfthd_ip_node->count++;
-    }
-    else if (status != SFXHASH_OK)
-    {
-        /* hash error */
-        return 1; /*  check the next threshold object */
-    }
-    else
-    {
-        /* Was not in the table - it was added - work with our copy of the data */
-        sfthd_ip_node = &data;
-    }
+    return sfthd_test_ip_node(local_hash, &key, sfthd_node, curtime);
+}
 
-    return sfthd_test_non_suppress(sfthd_node, sfthd_ip_node, curtime);
+int sfthd_test_local(
+    SFXHASH* local_hash,
+    THD_NODE* sfthd_node,
+    const SfIp* sip,
+    const SfIp* dip,
+    time_t curtime)
+{
+    return sfthd_test_local_node(local_hash, sfthd_node, sip, dip, curtime);
 }
 
 /*
  *   Test a global thresholding object
  */
 static inline int sfthd_test_global(
-    SFXHASH* global_hash,
+    FilterHash* global_hash,
     THD_NODE* sfthd_node,
     unsigned sig_id,     /* from current event */
     const SfIp* sip,        /* " */
@@ -955,9 +993,6 @@ static inline int sfthd_test_global(
     time_t curtime)
 {
     THD_IP_GNODE_KEY key;
-    THD_IP_NODE data;
-    THD_IP_NODE* sfthd_ip_node;
-    int status=0;
     const SfIp* ip;
 
     PolicyId policy_id = get_network_policy()->policy_id;
@@ -1006,33 +1041,7 @@ static inline int sfthd_test_global(
     key.policyId = policy_id;
     key.padding = 0;
 
-    /* Set up a new data element */
-    data.count  = 1;
-    data.prev  = 0;
-    data.tstart = data.tlast = curtime; /* Event time */
-
-    /* Check for any Permanent sig_id objects for this gen_id  or add this one ...  */
-    status = sfxhash_add(global_hash, (void*)&key, &data);
-    if (status == SFXHASH_INTABLE)
-    {
-        /* Already in the table */
-        sfthd_ip_node = (THD_IP_NODE*)global_hash->cnode->data;
-
-        /* Increment the event count */
-        sfthd_ip_node->count++;
-    }
-    else if (status != SFXHASH_OK)
-    {
-        /* hash error */
-        return 1; /*  check the next threshold object */
-    }
-    else
-    {
-        /* Was not in the table - it was added - work with our copy of the data */
-        sfthd_ip_node = &data;
-    }
-
-    return sfthd_test_non_suppress(sfthd_node, sfthd_ip_node, curtime);
+    return sfthd_test_ip_node(global_hash, &key, sfthd_node, curtime);
 }
 
 /*!
@@ -1152,7 +1161,7 @@ int sfthd_test_threshold(
         /*
          *   Test SUPPRESSION and THRESHOLDING
          */
-        status = sfthd_test_local(thd->ip_nodes, sfthd_node, sip, dip, curtime);
+        status = sfthd_test_local_node(thd->ip_nodes, sfthd_node, sip, dip, curtime);
 
         if ( status < 0 ) /* -1 == Don't log and stop looking */
         {
@@ -31,6 +31,7 @@
 #include "sfip/sf_ip.h"
 #include "utils/cpp_macros.h"
 
+class FilterHash;
 struct SFGHASH;
 struct SFXHASH;
 typedef struct sf_list SF_LIST;
@@ -185,12 +186,12 @@ typedef struct
     The main thresholding data structure.
 
     Local and global threshold thd_id's are all unqiue, so we use just one
-    ip_nodes lookup table
+    ip_nodes lookup table.  Both tables are shared by all packet threads.
  */
 struct THD_STRUCT
 {
-    SFXHASH* ip_nodes;   /* Global hash of active IP's key=THD_IP_NODE_KEY, data=THD_IP_NODE */
-    SFXHASH* ip_gnodes;  /* Global hash of active IP's key=THD_IP_GNODE_KEY, data=THD_IP_GNODE */
+    FilterHash* ip_nodes;   /* Global hash of active IP's key=THD_IP_NODE_KEY, data=THD_IP_NODE */
+    FilterHash* ip_gnodes;  /* Global hash of active IP's key=THD_IP_GNODE_KEY, data=THD_IP_GNODE */
 };
 
 struct ThresholdObjects
@@ -217,8 +218,8 @@ struct ThresholdObjects
 // gbytes = global threshold memcap (0 to disable global)
 THD_STRUCT* sfthd_new(unsigned lbytes, unsigned gbytes);
 SFXHASH* sfthd_local_new(unsigned bytes);
-SFXHASH* sfthd_global_new(unsigned bytes);
 void sfthd_free(THD_STRUCT*);
+void sfthd_reset_active(THD_STRUCT*);
 ThresholdObjects* sfthd_objs_new();
 void sfthd_objs_free(ThresholdObjects*);
 
@@ -18,6 +18,9 @@
 //--------------------------------------------------------------------------
 // sfthd_test.cc author Russ Combs <rcombs@sourcefire.com>
 
+#include <atomic>
+#include <thread>
+
 #include "catch/catch.hpp"
 #include "catch/unit_test.h"
 #include "hash/sfxhash.h"
@@ -734,6 +737,23 @@ static EventData pktData[] =
 
 #define NUM_PKTS (sizeof(pktData)/sizeof(pktData[0]))
 
+//---------------------------------------------------------------
+// event and global thresholds are shared by all packet threads
+// so the counts must be exact no matter which thread sees the event
+
+#define NUM_THREADS  4
+#define NUM_HOSTS   32
+#define NUM_REPEATS 100        // events per host per thread
+
+static ThreshData mtData[] =
+{
+    { 300, 1, THD_TRK_SRC, THD_TYPE_LIMIT,      5, 60, IP_ANY, 0, 0, nullptr }
+    ,{ 300, 2, THD_TRK_DST, THD_TYPE_THRESHOLD, 10, 60, IP_ANY, 0, 0, nullptr }
+    ,{ 301, 0, THD_TRK_SRC, THD_TYPE_LIMIT,      3, 60, IP_ANY, 0, 0, nullptr }
+};
+
+#define NUM_MTDS (sizeof(mtData)/sizeof(mtData[0]))
+
 //---------------------------------------------------------------
 
 static void Init(ThreshData* base, int max)
@@ -782,6 +802,13 @@ static void InitMincap()
     Init(thData, NUM_THDS);
 }
 
+static void InitThreads()
+{
+    pThdObjs = sfthd_objs_new();
+    pThd = sfthd_new(MEM_DEFAULT, MEM_DEFAULT);
+    Init(mtData, NUM_MTDS);
+}
+
 static void InitDetect()
 {
     dThd = sfthd_local_new(MEM_DEFAULT);
@@ -806,6 +833,7 @@ static void Term()
         }
     }
     sfxhash_delete(dThd);
+    dThd = NULL;
 }
 
 static int SetupCheck(int i)
@@ -906,6 +934,49 @@ static int PacketCheck(int i)
     return 0;
 }
 
+static void ThreadTest(
+    NetworkPolicy* np, unsigned gid, unsigned sid, std::atomic<unsigned>* logged)
+{
+    set_network_policy(np);
+
+    SfIp ip[NUM_HOSTS];
+    char s[32];
+
+    for ( unsigned h = 0; h < NUM_HOSTS; ++h )
+    {
+        snprintf(s, sizeof(s), "10.9.8.%u", h + 1);
+        ip[h].set(s);
+    }
+
+    unsigned n = 0;
+
+    for ( unsigned r = 0; r < NUM_REPEATS; ++r )
+    {
+        for ( unsigned h = 0; h < NUM_HOSTS; ++h )
+        {
+            if ( sfthd_test_threshold(pThdObjs, pThd, gid, sid, ip + h, ip + h, 0) == LOG_OK )
+                ++n;
+        }
+    }
+    *logged += n;
+}
+
+static unsigned ThreadCheck(unsigned gid, unsigned sid)
+{
+    std::atomic<unsigned> logged(0);
+    std::thread* th[NUM_THREADS];
+
+    for ( unsigned i = 0; i < NUM_THREADS; ++i )
+        th[i] = new std::thread(ThreadTest, get_network_policy(), gid, sid, &logged);
+
+    for ( unsigned i = 0; i < NUM_THREADS; ++i )
+    {
+        th[i]->join();
+        delete th[i];
+    }
+    return logged;
+}
+
 //---------------------------------------------------------------
 
 TEST_CASE("sfthd normal", "[sfthd]")
@@ -959,3 +1030,28 @@ TEST_CASE("sfthd detect", "[sfthd]")
     Term();
 }
 
+TEST_CASE("sfthd threads", "[sfthd]")
+{
+    InitThreads();
+
+    for ( unsigned i = 0; i < NUM_MTDS; ++i )
+        CHECK(mtData[i].create == 0);
+
+    const unsigned events = NUM_THREADS * NUM_REPEATS;
+
+    SECTION("limit")
+    {
+        CHECK(ThreadCheck(300, 1) == NUM_HOSTS * 5);
+    }
+    SECTION("threshold")
+    {
+        CHECK(ThreadCheck(300, 2) == NUM_HOSTS * (events / 10));
+    }
+    SECTION("global")
+    {
+        CHECK(ThreadCheck(301, 7) == NUM_HOSTS * 3);
+        CHECK(ThreadCheck(301, 8) == NUM_HOSTS * 3);
+    }
+    Term();
+}
+
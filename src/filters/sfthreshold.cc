@@ -38,7 +38,6 @@
 */
 #include "sfthreshold.h"
 
-#include "hash/sfxhash.h"
 #include "main/snort_config.h"
 #include "utils/util.h"
 
@@ -340,13 +339,6 @@ void sfthreshold_reset()
 /* empty out active entries */
 void sfthreshold_reset_active()
 {
-    if (thd_runtime == NULL)
-        return;
-
-    if (thd_runtime->ip_nodes != NULL)
-        sfxhash_make_empty(thd_runtime->ip_nodes);
-
-    if (thd_runtime->ip_gnodes != NULL)
-        sfxhash_make_empty(thd_runtime->ip_gnodes);
+    sfthd_reset_active(thd_runtime);
 }
 
@@ -29,9 +29,8 @@
 #include "stream/stream.h"      // FIXIT-M bad dependency
 #include "time/packet_time.h"
 
-/* Reasonably small, and prime */
-// FIXIT-L size based on max_tcp + max_udp?
-#define MAX_HASH 1021
+// minimum rows; rounded up to a power of 2
+#define MAX_HASH 1024
 #define MAX_LIST    8
 #define MAX_DATA    4
 #define MAX_WAIT  300
@@ -73,6 +72,15 @@ struct ExpectNode
     ExpectFlow* head = nullptr;
     ExpectFlow* tail = nullptr;
 
+    // expiry order; nodes move to the end whenever they are added to
+    ExpectNode* prev = nullptr;
+    ExpectNode* next = nullptr;
+
+    // one port is wild or both are known
+    FlowKey key;
+    unsigned index = 0;
+    bool wild = false;
+
     void clear(ExpectFlow*&);
 };
 
@@ -90,10 +98,91 @@ void ExpectNode::clear(ExpectFlow*& list)
     count = 0;
 }
 
+//-------------------------------------------------------------------------
+// index
+//-------------------------------------------------------------------------
+
+// the index counts nodes by a hash of the full key (exact) or of the
+// known address, port, and packet type (wild) so that most packets that
+// don't match need no hash table probe at all
+
+static inline uint32_t mix(uint32_t h, uint32_t w)
+{
+    h ^= w;
+    h *= 0x9e3779b1;
+    return h ^ (h >> 15);
+}
+
+static unsigned exact_hash(const FlowKey& key)
+{
+    const uint32_t* w = (const uint32_t*)&key;
+    uint32_t h = 0;
+
+    for ( unsigned i = 0; i < sizeof(key) / sizeof(*w); ++i )
+        h = mix(h, w[i]);
+
+    return h;
+}
+
+static unsigned wild_hash(const SfIp* ip, uint16_t port, PktType type)
+{
+    const uint32_t* w = ip->get_ip6_ptr();
+    uint32_t h = 1;
+
+    for ( unsigned i = 0; i < 4; ++i )
+        h = mix(h, w[i]);
+
+    return mix(h, ((uint32_t)port << 8) | (uint8_t)type);
+}
+
 //-------------------------------------------------------------------------
 // private ExpectCache methods
 //-------------------------------------------------------------------------
 
+void ExpectCache::link(ExpectNode* node)
+{
+    node->next = nullptr;
+    node->prev = tail;
+
+    if ( tail )
+        tail->next = node;
+    else
+        head = node;
+
+    tail = node;
+}
+
+void ExpectCache::unlink(ExpectNode* node)
+{
+    if ( node->prev )
+        node->prev->next = node->next;
+    else
+        head = node->next;
+
+    if ( node->next )
+        node->next->prev = node->prev;
+    else
+        tail = node->prev;
+
+    node->prev = node->next = nullptr;
+}
+
+void ExpectCache::remove(ExpectNode* node)
+{
+    unlink(node);
+
+    if ( node->wild )
+    {
+        --wild_index[node->index & index_mask];
+        --wild_count;
+    }
+    else
+        --exact_index[node->index & index_mask];
+
+    node->clear(free_list);
+    hash_table->remove(&node->key);
+}
+
 // Clean the hash table of at most MAX_PRUNE expired nodes
 void ExpectCache::prune()
 {
@@ -101,16 +190,23 @@ void ExpectCache::prune()
 
     for (unsigned i = 0; i < MAX_PRUNE; ++i )
     {
-        ExpectNode* node = (ExpectNode*)hash_table->first();
-
-        if ( !node || now <= node->expires )
+        if ( !head || now <= head->expires )
             break;
 
-        hash_table->remove();
+        remove(head);
         ++prunes;
     }
 }
 
+ExpectNode* ExpectCache::find_wild(
+    FlowKey& key, const SfIp* ip, uint16_t port, PktType type)
+{
+    if ( !wild_index[wild_hash(ip, port, type) & index_mask] )
+        return nullptr;
+
+    return (ExpectNode*)hash_table->find(&key);
+}
+
 ExpectNode* ExpectCache::find_node_by_packet(Packet* p, FlowKey &key)
 {
     if (!hash_table->get_count())
@@ -136,12 +232,15 @@ ExpectNode* ExpectCache::find_node_by_packet(Packet* p, FlowKey &key)
             2. Unknown (zeroed) source port.
             3. Unknown (zeroed) destination port.
         If the client/server addresses were reversed during key creation, the
-        source port will be in port_l.
+        source port will be in port_l.  Each step is skipped unless the index
+        says a node could match so a hit usually costs a single probe.
     */
-    // FIXIT-P X This should be optimized to only do full matches when full keys
-    //      are present, likewise for partial keys.
-    ExpectNode* node = (ExpectNode*) hash_table->find(&key);
-    if (!node)
+    ExpectNode* node = nullptr;
+
+    if ( exact_index[exact_hash(key) & index_mask] )
+        node = (ExpectNode*) hash_table->find(&key);
+
+    if ( !node && wild_count )
     {
         // FIXIT-M X This logic could fail if IPs were equal because the original key
         // would always have been created with a 0 for src or dst port and put the
@@ -158,19 +257,21 @@ ExpectNode* ExpectCache::find_node_by_packet(Packet* p, FlowKey &key)
             port2 = key.port_h;
             key.port_h = 0;
         }
-        node = (ExpectNode*) hash_table->find(&key);
+        node = find_wild(key, dstIP, p->ptrs.dp, type);
+
         if (!node)
         {
             key.port_l = port1;
             key.port_h = port2;
-            node = (ExpectNode*) hash_table->find(&key);
-            if (!node)
-                return nullptr;
+            node = find_wild(key, srcIP, p->ptrs.sp, type);
         }
     }
+    if (!node)
+        return nullptr;
+
     if (!node->head || (p->pkth->ts.tv_sec > node->expires))
     {
-        hash_table->remove(&key);
+        remove(node);
         return nullptr;
     }
     /* Make sure the packet direction is correct */
@@ -189,7 +290,7 @@ ExpectNode* ExpectCache::find_node_by_packet(Packet* p, FlowKey &key)
     return node;
 }
 
-bool ExpectCache::process_expected(ExpectNode* node, FlowKey& key, Packet* p, Flow* lws)
+bool ExpectCache::process_expected(ExpectNode* node, Packet* p, Flow* lws)
 {
     ExpectFlow* head;
     FlowData* fd;
@@ -221,7 +322,7 @@ bool ExpectCache::process_expected(ExpectNode* node, FlowKey& key, Packet* p, Fl
         lws->ssn_state.application_protocol = node->appId;
 
     if (!node->count)
-        hash_table->remove(&key);
+        remove(node);
 
     return ignoring;
 }
@@ -232,14 +333,26 @@ bool ExpectCache::process_expected(ExpectNode* node, FlowKey& key, Packet* p, Fl
 
 ExpectCache::ExpectCache(uint32_t max)
 {
-    // -size forces use of abs(size) ie w/o bumping up
-    hash_table = new ZHash(-MAX_HASH, sizeof(FlowKey));
+    hash_table = new ZHash(max > MAX_HASH ? max : MAX_HASH, sizeof(FlowKey));
     hash_table->set_keyops(FlowKey::hash, FlowKey::compare);
 
     nodes = new ExpectNode[max];
     for (unsigned i = 0; i < max; ++i)
         hash_table->push(nodes+i);
 
+    head = tail = nullptr;
+    wild_count = 0;
+
+    // a few slots per node keeps false positives rare
+    unsigned slots = MAX_HASH;
+
+    while ( slots < 4 * max )
+        slots <<= 1;
+
+    index_mask = slots - 1;
+    exact_index = new unsigned[slots]();
+    wild_index = new unsigned[slots]();
+
     /* Preallocate a pool of ExpectFlows big enough to handle the worst case
         requirement (max number of nodes * max flows per node) and add them all
         to an initial free list. */
@@ -263,6 +376,8 @@ ExpectCache::~ExpectCache()
     delete hash_table;
     delete[] nodes;
     delete[] pool;
+    delete[] exact_index;
+    delete[] wild_index;
 }
 
 /**Either expect or expect future session.
@@ -317,6 +432,9 @@ int ExpectCache::add_flow(const Packet *ctrlPkt,
         }
     }
 
+    // nodes already in the table are also in the index and expiry list
+    bool indexed = !new_node;
+
     /* If the node is past its expiration date, whack it and reuse it. */
     if (!new_node && packet_time() > node->expires)
     {
@@ -324,6 +442,26 @@ int ExpectCache::add_flow(const Packet *ctrlPkt,
         new_node = true;
     }
 
+    if (!indexed)
+    {
+        // exactly one known port goes in the wild index under the known side
+        node->key = key;
+        node->wild = !cliPort != !srvPort;
+
+        if ( !node->wild )
+        {
+            node->index = exact_hash(key);
+            ++exact_index[node->index & index_mask];
+        }
+        else
+        {
+            node->index = cliPort ? wild_hash(cliIP, cliPort, type) :
+                wild_hash(srvIP, srvPort, type);
+            ++wild_index[node->index & index_mask];
+            ++wild_count;
+        }
+    }
+
     if (!new_node)
     {
         /* Requests will be rejected if the AppID doesn't match what has already been set. */
@@ -395,6 +533,11 @@ int ExpectCache::add_flow(const Packet *ctrlPkt,
         last->data = fd;
 
     node->expires = packet_time() + MAX_WAIT;
+
+    if (indexed)
+        unlink(node);
+
+    link(node);
     ++expects;
 
     return 0;
@@ -414,6 +557,6 @@ bool ExpectCache::check(Packet* p, Flow* lws)
     if (!node)
         return false;
 
-    return process_expected(node, key, p, lws);
+    return process_expected(node, p, lws);
 }
 
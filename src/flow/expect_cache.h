@@ -38,7 +38,11 @@
 // -- when a new expect is added, the last list struct is used if the
 //    given preproc id is not already in the flow data list
 // -- nodes are preallocated and stored in hash table; if there is no node
-//    available when an expect is added, LRU nodes are pruned
+//    available when an expect is added, expired nodes are pruned oldest
+//    first from a list kept in expiration order
+// -- an index counts nodes by a hash of the full key, or for keys with a
+//    wild port, of the known address, port, and protocol; lookups only
+//    probe the hash table when the index has a count for the packet
 // -- list structs are also preallocated and stored in free list; if there
 //    is no list struct available when an expect is added, LRU nodes are
 //    pruned freeing up both nodes and list structs
@@ -88,18 +92,30 @@ public:
 
 private:
     void prune();
+    void link(ExpectNode*);
+    void unlink(ExpectNode*);
+    void remove(ExpectNode*);
 
     ExpectNode* get_node(FlowKey&, bool&);
     ExpectFlow* get_flow(ExpectNode*, uint32_t, int16_t);
     bool set_data(ExpectNode*, ExpectFlow*&, FlowData*);
+    ExpectNode* find_wild(FlowKey&, const SfIp*, uint16_t, PktType);
     ExpectNode* find_node_by_packet(Packet*, FlowKey&);
-    bool process_expected(ExpectNode*, FlowKey&, Packet*, Flow*);
+    bool process_expected(ExpectNode*, Packet*, Flow*);
 
 private:
     class ZHash* hash_table;
     ExpectNode* nodes;
     ExpectFlow* pool, * free_list;
 
+    // oldest first
+    ExpectNode* head, * tail;
+
+    unsigned* exact_index;
+    unsigned* wild_index;
+    unsigned index_mask;
+    unsigned wild_count;
+
     unsigned long expects, realized;
     unsigned long prunes, overflows;
 };
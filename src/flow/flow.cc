@@ -176,6 +176,7 @@ void Flow::restart(bool dump_flow_data)
 
     session_state = STREAM_STATE_NONE;
     expire_time = 0;
+    bypass_expire = 0;
     previous_ssn_state = ssn_state;
 }
 
@@ -201,6 +202,9 @@ void Flow::clear(bool dump_flow_data)
         clear_gadget();
 }
 
+static inline unsigned get_slot(unsigned id)
+{ return id & (Flow::flow_data_slots - 1); }
+
 int Flow::set_flow_data(FlowData* fd)
 {
     FlowData* old = get_flow_data(fd->get_id());
@@ -216,12 +220,23 @@ int Flow::set_flow_data(FlowData* fd)
         flow_data->prev = fd;
 
     flow_data = fd;
+
+    FlowData*& slot = flow_data_slot[get_slot(fd->get_id())];
+
+    if ( !slot )
+        slot = fd;
+
     return 0;
 }
 
 FlowData* Flow::get_flow_data(unsigned id)
 {
-    FlowData* fd = flow_data;
+    FlowData* fd = flow_data_slot[get_slot(id)];
+
+    if ( !fd or fd->get_id() == id )
+        return fd;
+
+    fd = flow_data;
 
     while (fd)
     {
@@ -250,6 +265,19 @@ void Flow::free_flow_data(FlowData* fd)
         fd->prev->next = fd->next;
         fd->next->prev = fd->prev;
     }
+
+    unsigned i = get_slot(fd->get_id());
+
+    if ( flow_data_slot[i] == fd )
+    {
+        // hand the slot to any other data with the same index
+        FlowData* p = flow_data;
+
+        while ( p and get_slot(p->get_id()) != i )
+            p = p->next;
+
+        flow_data_slot[i] = p;
+    }
     delete fd;
 }
 
@@ -272,6 +300,7 @@ void Flow::free_flow_data()
         delete tmp;
     }
     flow_data = nullptr;
+    memset(flow_data_slot, 0, sizeof(flow_data_slot));
 }
 
 void Flow::call_handlers(Packet* p, bool eof)
@@ -292,6 +292,17 @@ public:
         return disable_inspect;
     }
 
+    // packets on a bypassed flow skip the normal flow control path until
+    // the given time; see FlowControl::bypass()
+    void set_bypass(long until)
+    { bypass_expire = until; }
+
+    void clear_bypass()
+    { bypass_expire = 0; }
+
+    bool is_bypassed() const
+    { return bypass_expire != 0; }
+
 public:  // FIXIT-M privatize if possible
     // fields are organized by initialization and size to minimize
     // void space and allow for memset of tail end of struct
@@ -307,6 +318,9 @@ public:  // FIXIT-M privatize if possible
 
     // these fields are always set; not zeroed
     Flow* prev, * next;
+    Flow* wheel_prev, * wheel_next;  // owned by FlowWheel
+    Flow** wheel_slot;               // ^^
+    long wheel_time;                 // zero if not scheduled
     Inspector* ssn_client;
     Inspector* ssn_server;
 
@@ -315,6 +329,13 @@ public:  // FIXIT-M privatize if possible
 
     // everything from here down is zeroed
     FlowData* flow_data;
+
+    // direct mapped by FlowData id so most lookups, hit or miss, don't
+    // walk the list.  a slot holds the data for one id with that index;
+    // others with the same index are only found on the list.  an empty
+    // slot means no data with that index is on the flow.
+    static const unsigned flow_data_slots = 8;
+    FlowData* flow_data_slot[flow_data_slots];
     Inspector* clouseau;  // service identifier
     Inspector* gadget;    // service handler
     Inspector* data;
@@ -322,6 +343,10 @@ public:  // FIXIT-M privatize if possible
 
     uint64_t expire_time;
 
+    long bypass_expire;
+    uint64_t bypass_packets;
+    uint64_t bypass_bytes;
+
     SfIp client_ip;
     SfIp server_ip;
 
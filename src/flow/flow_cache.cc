@@ -24,6 +24,7 @@
 #include "config.h"
 #endif
 
+#include "flow/flow_pool.h"
 #include "flow/ha.h"
 #include "hash/zhash.h"
 #include "helpers/flag_context.h"
@@ -33,13 +34,18 @@
 #include "time/packet_time.h"
 #include "utils/stats.h"
 
+#ifdef UNIT_TEST
+#include <cstring>
+#include "catch/catch.hpp"
+#endif
+
 #define SESSION_CACHE_FLAG_PURGING  0x01
 
 //-------------------------------------------------------------------------
 // FlowCache stuff
 //-------------------------------------------------------------------------
 
-FlowCache::FlowCache (const FlowConfig& cfg) : config(cfg)
+FlowCache::FlowCache (const FlowConfig& cfg, FlowPool& fp) : config(cfg), pool(fp)
 {
     hash_table = new ZHash(config.max_sessions, sizeof(FlowKey));
     hash_table->set_keyops(FlowKey::hash, FlowKey::compare);
@@ -122,7 +128,8 @@ void FlowCache::unlink_uni(Flow* flow)
 Flow* FlowCache::get(const FlowKey* key)
 {
     time_t timestamp = packet_time();
-    Flow* flow = (Flow*)hash_table->get(key);
+    bool new_node = false;
+    Flow* flow = (Flow*)hash_table->get(key, &new_node);
 
     if ( !flow )
     {
@@ -134,11 +141,28 @@ Flow* FlowCache::get(const FlowKey* key)
 
         flow = (Flow*)hash_table->get(key);
 
+        // nothing to recycle so take a new flow while under quota
+        if ( !flow )
+        {
+            if ( Flow* mem = pool.get() )
+                push(mem);
+
+            else if ( !prune_one(PruneReason::MEMCAP, true) )
+                return nullptr;
+
+            flow = (Flow*)hash_table->get(key);
+        }
+
         assert(flow);
         flow->reset();
         link_uni(flow);
+        new_node = true;
     }
 
+    // recycled flows come off the free list so they're scheduled here too
+    if ( new_node )
+        timeouts.add(flow, timestamp + config.nominal_timeout);
+
     flow->last_data_seen = timestamp;
 
     return flow;
@@ -156,6 +180,8 @@ int FlowCache::remove(Flow* flow)
     if ( flow->next )
         unlink_uni(flow);
 
+    timeouts.remove(flow);
+
     return hash_table->remove(flow->key);
 }
 
@@ -291,24 +317,32 @@ bool FlowCache::prune_one(PruneReason reason, bool do_cleanup)
     return true;
 }
 
+// flows aren't rescheduled as they see traffic so when one comes due it
+// is retired only if it has really been idle, otherwise it goes back on
+// the wheel at its actual expiry
 unsigned FlowCache::timeout(unsigned num_flows, time_t thetime)
 {
     // FIXIT-H should Active be suspended here too?
     unsigned retired = 0;
 
-    auto flow = static_cast<Flow*>(hash_table->current());
-
-    if ( !flow )
-        flow = static_cast<Flow*>(hash_table->first());
-
-    while ( flow and (retired < num_flows) )
+    while ( retired < num_flows )
     {
-        if ( flow->last_data_seen + config.nominal_timeout > thetime )
+        Flow* flow = timeouts.expire(thetime);
+
+        if ( !flow )
             break;
 
+        long when = flow->last_data_seen + config.nominal_timeout;
+
+        if ( when > thetime )
+        {
+            timeouts.add(flow, when);
+            continue;
+        }
+
         if ( HighAvailabilityManager::in_standby(flow) )
         {
-            flow = static_cast<Flow*>(hash_table->next());
+            timeouts.add(flow, thetime + (config.nominal_timeout ? config.nominal_timeout : 1));
             continue;
         }
 
@@ -317,8 +351,6 @@ unsigned FlowCache::timeout(unsigned num_flows, time_t thetime)
         release(flow, PruneReason::IDLE);
 
         ++retired;
-
-        flow = static_cast<Flow*>(hash_table->current());
     }
 
     return retired;
@@ -341,3 +373,87 @@ unsigned FlowCache::purge()
     return retired;
 }
 
+
+//-------------------------------------------------------------------------
+// unit tests
+//-------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+static void set_time(time_t t)
+{
+    struct timeval tv = { t, 0 };
+    packet_time_update(&tv);
+}
+
+TEST_CASE("flow cache timeout", "[flow]")
+{
+    FlowConfig fc;
+    fc.max_sessions = 8;
+    fc.nominal_timeout = 10;
+
+    FlowPool pool;
+    FlowCache cache(fc, pool);
+
+    const unsigned num_flows = 4;
+    FlowKey keys[num_flows];
+    memset(keys, 0, sizeof(keys));
+
+    // all flows share the slot for 1010
+    set_time(1000);
+
+    for ( unsigned i = 0; i < num_flows; ++i )
+    {
+        keys[i].pkt_type = PktType::UDP;
+        keys[i].port_l = i + 1;
+        REQUIRE(cache.get(keys + i));
+    }
+    CHECK(cache.get_count() == num_flows);
+
+    SECTION("retire idle")
+    {
+        CHECK(cache.timeout(num_flows, 1009) == 0);
+        CHECK(cache.timeout(num_flows, 1010) == num_flows);
+        CHECK(cache.get_count() == 0);
+        CHECK(cache.get_prunes(PruneReason::IDLE) == num_flows);
+        CHECK(cache.timeout(num_flows, 1100) == 0);
+    }
+
+    SECTION("retire some")
+    {
+        CHECK(cache.timeout(2, 1010) == 2);
+        CHECK(cache.get_count() == 2);
+        CHECK(cache.timeout(num_flows, 1010) == 2);
+        CHECK(cache.get_count() == 0);
+    }
+
+    SECTION("reschedule active")
+    {
+        set_time(1005);
+        REQUIRE(cache.find(keys + 1));
+
+        CHECK(cache.timeout(num_flows, 1010) == num_flows - 1);
+        CHECK(cache.get_count() == 1);
+        CHECK(cache.find(keys + 1));
+
+        CHECK(cache.timeout(num_flows, 1014) == 0);
+        CHECK(cache.timeout(num_flows, 1015) == 1);
+        CHECK(cache.get_count() == 0);
+    }
+
+    SECTION("reuse")
+    {
+        CHECK(cache.timeout(num_flows, 1010) == num_flows);
+
+        set_time(1020);
+
+        for ( unsigned i = 0; i < num_flows; ++i )
+            REQUIRE(cache.get(keys + i));
+
+        CHECK(cache.release(cache.find(keys + 2)));
+        CHECK(cache.timeout(num_flows, 1030) == num_flows - 1);
+        CHECK(cache.get_count() == 0);
+    }
+}
+
+#endif
@@ -29,15 +29,17 @@
 #include <type_traits>
 
 #include "flow_config.h"
+#include "flow_wheel.h"
 #include "prune_stats.h"
 
 class Flow;
+class FlowPool;
 struct FlowKey;
 
 class FlowCache
 {
 public:
-    FlowCache(const FlowConfig&);
+    FlowCache(const FlowConfig&, FlowPool&);
 
     ~FlowCache();
 
@@ -78,11 +80,13 @@ private:
 private:
     static const unsigned cleanup_flows = 1;
     const FlowConfig& config;
+    FlowPool& pool;
     unsigned uni_count;
     uint32_t flags;
 
     class ZHash* hash_table;
     Flow* uni_head, * uni_tail;
+    FlowWheel timeouts;
     PruneStats prune_stats;
 };
 
@@ -25,6 +25,7 @@
 #include <cassert>
 
 #include "detection/detect.h"
+#include "framework/data_bus.h"
 #include "managers/inspector_manager.h"
 #include "memory/memory_cap.h"
 #include "packet_io/active.h"
@@ -40,10 +41,11 @@
 #include "expect_cache.h"
 #include "flow_cache.h"
 #include "flow_config.h"
+#include "flow_pool.h"
 #include "session.h"
 
 FlowControl::FlowControl()
-{ }
+{ pool = new FlowPool; }
 
 FlowControl::~FlowControl()
 {
@@ -55,12 +57,7 @@ FlowControl::~FlowControl()
     delete file_cache;
     delete exp_cache;
 
-    snort_free(ip_mem);
-    snort_free(icmp_mem);
-    snort_free(tcp_mem);
-    snort_free(udp_mem);
-    snort_free(user_mem);
-    snort_free(file_mem);
+    delete pool;
 }
 
 //-------------------------------------------------------------------------
@@ -74,6 +71,10 @@ static THREAD_LOCAL PegCount udp_count = 0;
 static THREAD_LOCAL PegCount user_count = 0;
 static THREAD_LOCAL PegCount file_count = 0;
 
+static THREAD_LOCAL PegCount bypass_packets = 0;
+static THREAD_LOCAL PegCount bypass_bytes = 0;
+static THREAD_LOCAL PegCount bypass_revalidations = 0;
+
 PegCount FlowControl::get_flows(PktType type)
 {
     switch ( type )
@@ -100,11 +101,21 @@ PegCount FlowControl::get_prunes(PktType type, PruneReason reason) const
     return cache ? cache->get_prunes(reason) : 0;
 }
 
+PegCount FlowControl::get_bypass_packets() const
+{ return bypass_packets; }
+
+PegCount FlowControl::get_bypass_bytes() const
+{ return bypass_bytes; }
+
+PegCount FlowControl::get_bypass_revalidations() const
+{ return bypass_revalidations; }
+
 void FlowControl::clear_counts()
 {
     ip_count = icmp_count = 0;
     tcp_count = udp_count = 0;
     user_count = file_count = 0;
+    bypass_packets = bypass_bytes = bypass_revalidations = 0;
 
     FlowCache* cache;
 
@@ -218,6 +229,8 @@ bool FlowControl::prune_one(PruneReason reason, bool do_cleanup)
     return cache ? cache->prune_one(reason, do_cleanup) : false;
 }
 
+static const unsigned idle_timeouts = 8;
+
 void FlowControl::timeout_flows(time_t cur_time)
 {
     if ( !types.size() )
@@ -229,8 +242,10 @@ void FlowControl::timeout_flows(time_t cur_time)
     if ( ++next >= types.size() )
         next = 0;
 
+    // the wheel makes each retirement O(1) so take a few per call while
+    // still bounding the time spent here
     if ( fc )
-        fc->timeout(1, cur_time);
+        fc->timeout(idle_timeouts, cur_time);
 
     Active::resume();
 }
@@ -240,6 +255,10 @@ void FlowControl::preemptive_cleanup()
     DebugFormat(DEBUG_FLOW, "doing preemptive cleanup for packet of type %u",
             (unsigned) last_pkt_type);
 
+    // the lower tiers scale back inspection; only the last prunes flows
+    if ( memory::MemoryCap::update_tier() < memory::MemoryCap::TIER_PRUNE )
+        return;
+
     // FIXIT-H is there a possibility of this looping forever?
     while ( memory::MemoryCap::over_threshold() )
     {
@@ -396,11 +415,47 @@ static void init_roles(Packet* p, Flow* flow)
     }
 }
 
+// the fast path is only armed for trusted (ALLOW) flows.  those already
+// skip the session, inspection, and detection on the normal path, so this
+// only saves preemptive cleanup, the session precheck (expiry), and the
+// state switch.  it expires after bypass_timeout seconds, at which point
+// the next packet revalidates the flow by taking the normal path again.
+bool FlowControl::bypass(Flow* flow, Packet* p)
+{
+    if ( p->pkth->ts.tv_sec >= flow->bypass_expire )
+    {
+        flow->clear_bypass();
+        ++bypass_revalidations;
+        get_data_bus().publish(FLOW_BYPASS_EXPIRED_EVENT, p, flow);
+        return false;
+    }
+
+    p->flow = flow;
+    p->disable_inspect = true;
+
+    flow->set_direction(p);
+    set_policies(snort_conf, flow->policy_id);
+
+    DisableInspection();
+    p->ptrs.decode_flags |= DECODE_PKT_TRUST;
+
+    flow->bypass_packets++;
+    flow->bypass_bytes += p->pkth->pktlen;
+
+    ++bypass_packets;
+    bypass_bytes += p->pkth->pktlen;
+    return true;
+}
+
 unsigned FlowControl::process(Flow* flow, Packet* p)
 {
     unsigned news = 0;
 
     assert ( flow );
+
+    if ( flow->is_bypassed() && bypass(flow, p) )
+        return 0;
+
     flow->previous_ssn_state = flow->ssn_state;
 
     p->flow = flow;
@@ -476,6 +531,14 @@ unsigned FlowControl::process(Flow* flow, Packet* p)
         break;
     }
 
+    // ignored flows (stop inspection) are not bypassed since their session
+    // must keep tracking them
+    if ( bypass_timeout && !flow->was_blocked() &&
+        flow->flow_state == Flow::FlowState::ALLOW )
+    {
+        flow->set_bypass(p->pkth->ts.tv_sec + bypass_timeout);
+    }
+
     return news;
 }
 
@@ -489,11 +552,7 @@ void FlowControl::init_ip(
     if ( !fc.max_sessions || !get_ssn )
         return;
 
-    ip_cache = new FlowCache(fc);
-    ip_mem = (Flow*)snort_calloc(fc.max_sessions, sizeof(Flow));
-
-    for ( unsigned i = 0; i < fc.max_sessions; ++i )
-        ip_cache->push(ip_mem + i);
+    ip_cache = new FlowCache(fc, *pool);
 
     get_ip = get_ssn;
     types.push_back(PktType::IP);
@@ -533,11 +592,7 @@ void FlowControl::init_icmp(
     if ( !fc.max_sessions || !get_ssn )
         return;
 
-    icmp_cache = new FlowCache(fc);
-    icmp_mem = (Flow*)snort_calloc(fc.max_sessions, sizeof(Flow));
-
-    for ( unsigned i = 0; i < fc.max_sessions; ++i )
-        icmp_cache->push(icmp_mem + i);
+    icmp_cache = new FlowCache(fc, *pool);
 
     get_icmp = get_ssn;
     types.push_back(PktType::ICMP);
@@ -580,11 +635,7 @@ void FlowControl::init_tcp(
     if ( !fc.max_sessions || !get_ssn )
         return;
 
-    tcp_cache = new FlowCache(fc);
-    tcp_mem = (Flow*)snort_calloc(fc.max_sessions, sizeof(Flow));
-
-    for ( unsigned i = 0; i < fc.max_sessions; ++i )
-        tcp_cache->push(tcp_mem + i);
+    tcp_cache = new FlowCache(fc, *pool);
 
     get_tcp = get_ssn;
     types.push_back(PktType::TCP);
@@ -624,11 +675,7 @@ void FlowControl::init_udp(
     if ( !fc.max_sessions || !get_ssn )
         return;
 
-    udp_cache = new FlowCache(fc);
-    udp_mem = (Flow*)snort_calloc(fc.max_sessions, sizeof(Flow));
-
-    for ( unsigned i = 0; i < fc.max_sessions; ++i )
-        udp_cache->push(udp_mem + i);
+    udp_cache = new FlowCache(fc, *pool);
 
     get_udp = get_ssn;
     types.push_back(PktType::UDP);
@@ -668,11 +715,7 @@ void FlowControl::init_user(
     if ( !fc.max_sessions || !get_ssn )
         return;
 
-    user_cache = new FlowCache(fc);
-    user_mem = (Flow*)snort_calloc(fc.max_sessions, sizeof(Flow));
-
-    for ( unsigned i = 0; i < fc.max_sessions; ++i )
-        user_cache->push(user_mem + i);
+    user_cache = new FlowCache(fc, *pool);
 
     get_user = get_ssn;
     types.push_back(PktType::PDU);
@@ -712,11 +755,7 @@ void FlowControl::init_file(
     if ( !fc.max_sessions || !get_ssn )
         return;
 
-    file_cache = new FlowCache(fc);
-    file_mem = (Flow*)snort_calloc(fc.max_sessions, sizeof(Flow));
-
-    for ( unsigned i = 0; i < fc.max_sessions; ++i )
-        file_cache->push(file_mem + i);
+    file_cache = new FlowCache(fc, *pool);
 
     get_file = get_ssn;
     types.push_back(PktType::FILE);
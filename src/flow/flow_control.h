@@ -36,12 +36,18 @@
 class Flow;
 class FlowData;
 class FlowCache;
+class FlowPool;
 struct FlowKey;
 struct Packet;
 struct SfIp;
 
 enum class PruneReason : uint8_t;
 
+// published when a bypassed flow's fast path expires, before the packet
+// takes the normal path.  handlers may change the flow state or ignore
+// direction to keep the flow off the fast path.
+#define FLOW_BYPASS_EXPIRED_EVENT "flow.bypass_expired"
+
 class FlowControl
 {
 public:
@@ -93,8 +99,17 @@ public:
     PegCount get_total_prunes(PktType) const;
     PegCount get_prunes(PktType, PruneReason) const;
 
+    PegCount get_bypass_packets() const;
+    PegCount get_bypass_bytes() const;
+    PegCount get_bypass_revalidations() const;
+
     void clear_counts();
 
+    // trusted flows take the fast path for this many seconds before going
+    // back through the normal path; 0 disables the fast path
+    void set_bypass_timeout(unsigned t)
+    { bypass_timeout = t; }
+
 private:
     FlowCache* get_cache(PktType);
     const FlowCache* get_cache(PktType) const;
@@ -102,6 +117,7 @@ private:
     void set_key(FlowKey*, Packet*);
 
     unsigned process(Flow*, Packet*);
+    bool bypass(Flow*, Packet*);
     void preemptive_cleanup();
 
 private:
@@ -112,13 +128,8 @@ private:
     FlowCache* user_cache = nullptr;
     FlowCache* file_cache = nullptr;
 
-    // preallocated arrays
-    Flow* ip_mem = nullptr;
-    Flow* icmp_mem = nullptr;
-    Flow* tcp_mem = nullptr;
-    Flow* udp_mem = nullptr;
-    Flow* user_mem = nullptr;
-    Flow* file_mem = nullptr;
+    // flow memory shared by all caches
+    FlowPool* pool;
 
     InspectSsnFunc get_ip = nullptr;
     InspectSsnFunc get_icmp = nullptr;
@@ -129,6 +140,7 @@ private:
 
     class ExpectCache* exp_cache = nullptr;
     PktType last_pkt_type = PktType::NONE;
+    unsigned bypass_timeout = 0;
 
     std::vector<PktType> types;
     unsigned next = 0;
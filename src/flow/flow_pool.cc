@@ -0,0 +1,87 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// flow_pool.cc
+
+#include "flow/flow_pool.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <sys/mman.h>
+
+#include <cstdint>
+
+#include "flow/flow.h"
+#include "main/snort_debug.h"
+#include "memory/memory_cap.h"
+
+static_assert(sizeof(Flow) <= FlowPool::slab_size, "slab too small for a flow");
+
+FlowPool::~FlowPool()
+{
+    for ( auto p : slabs )
+    {
+        munmap(p, slab_size);
+        memory::MemoryCap::update_deallocations(slab_size);
+    }
+}
+
+// map twice the size so a slab_size aligned slab can be cut from the
+// middle; only aligned 2M ranges are eligible for huge pages
+bool FlowPool::add_slab()
+{
+    if ( !memory::MemoryCap::free_space(slab_size) )
+        return false;
+
+    size_t len = 2 * slab_size;
+    void* map = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+    if ( map == MAP_FAILED )
+        return false;
+
+    uint8_t* base = (uint8_t*)map;
+    uint8_t* slab = (uint8_t*)(((uintptr_t)base + slab_size - 1) & ~(uintptr_t)(slab_size - 1));
+
+    if ( slab > base )
+        munmap(base, slab - base);
+
+    if ( base + len > slab + slab_size )
+        munmap(slab + slab_size, base + len - slab - slab_size);
+
+#ifdef MADV_HUGEPAGE
+    madvise(slab, slab_size, MADV_HUGEPAGE);
+#endif
+
+    memory::MemoryCap::update_allocations(slab_size);
+    slabs.push_back(slab);
+
+    next = (Flow*)slab;
+    last = next + slab_size / sizeof(Flow);
+
+    DebugFormat(DEBUG_MEMORY, "flow pool slab %zu added\n", slabs.size());
+    return true;
+}
+
+Flow* FlowPool::get()
+{
+    if ( next == last and !add_slab() )
+        return nullptr;
+
+    return next++;
+}
@@ -0,0 +1,57 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// flow_pool.h
+
+#ifndef FLOW_POOL_H
+#define FLOW_POOL_H
+
+// FlowPool hands out zeroed flow memory to all of a packet thread's flow
+// caches.  caches take flows on demand up to their max_sessions quota and
+// recycle their own flows after that so only the flows actually used
+// become resident.  memory comes from large anonymous mappings which are
+// committed by the kernel as touched, aligned and advised for transparent
+// huge pages to cut tlb misses, and charged against the memory cap.
+
+#include <cstddef>
+#include <vector>
+
+class Flow;
+
+class FlowPool
+{
+public:
+    FlowPool() = default;
+    ~FlowPool();
+
+    // returns nullptr if a new slab is needed and can't be had
+    Flow* get();
+
+    size_t get_slab_count() const
+    { return slabs.size(); }
+
+    static const size_t slab_size = 2 * 1024 * 1024;
+
+private:
+    bool add_slab();
+
+    std::vector<void*> slabs;
+    Flow* next = nullptr;
+    Flow* last = nullptr;
+};
+
+#endif
@@ -0,0 +1,253 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// flow_wheel.cc
+
+#include "flow/flow_wheel.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <cassert>
+#include <cstring>
+
+#include "flow/flow.h"
+
+#ifdef UNIT_TEST
+#include "catch/catch.hpp"
+#endif
+
+static const unsigned slot_mask = FlowWheel::num_slots - 1;
+static const unsigned coarse_mask = FlowWheel::num_coarse - 1;
+
+FlowWheel::FlowWheel()
+{
+    memset(slots, 0, sizeof(slots));
+    memset(coarse, 0, sizeof(coarse));
+    cursor = 0;
+    count = 0;
+}
+
+// flows due in this revolution of the cursor go on the fine level by
+// second and the rest on the coarse level by revolution
+Flow** FlowWheel::get_slot(long when)
+{
+    if ( when - cursor < (long)num_slots )
+        return slots + (when & slot_mask);
+
+    return coarse + ((when / num_slots) & coarse_mask);
+}
+
+void FlowWheel::link(Flow* flow, Flow** slot)
+{
+    flow->wheel_slot = slot;
+    flow->wheel_prev = nullptr;
+    flow->wheel_next = *slot;
+
+    if ( *slot )
+        (*slot)->wheel_prev = flow;
+
+    *slot = flow;
+}
+
+// called when the cursor starts a revolution; its coarse slot moves down
+// except for flows that wrapped, which go back up
+void FlowWheel::cascade()
+{
+    Flow*& head = coarse[(cursor / num_slots) & coarse_mask];
+    Flow* flow = head;
+    head = nullptr;
+
+    while ( flow )
+    {
+        Flow* next = flow->wheel_next;
+        link(flow, get_slot(flow->wheel_time));
+        flow = next;
+    }
+}
+
+// anything scheduled before the cursor goes in the current slot so it
+// comes out on the next call to expire(); a zero wheel_time means the
+// flow isn't scheduled so nothing is ever put at time zero
+void FlowWheel::add(Flow* flow, long when)
+{
+    remove(flow);
+
+    if ( when < 1 )
+        when = 1;
+
+    if ( !cursor )
+        cursor = when;
+
+    else if ( when < cursor )
+        when = cursor;
+
+    flow->wheel_time = when;
+    link(flow, get_slot(when));
+    ++count;
+}
+
+// flows handed out by expire() are already off the wheel
+void FlowWheel::remove(Flow* flow)
+{
+    if ( !flow->wheel_time )
+        return;
+
+    if ( flow->wheel_prev )
+        flow->wheel_prev->wheel_next = flow->wheel_next;
+    else
+    {
+        assert(*flow->wheel_slot == flow);
+        *flow->wheel_slot = flow->wheel_next;
+    }
+
+    if ( flow->wheel_next )
+        flow->wheel_next->wheel_prev = flow->wheel_prev;
+
+    flow->wheel_prev = flow->wheel_next = nullptr;
+    flow->wheel_slot = nullptr;
+    flow->wheel_time = 0;
+    --count;
+}
+
+// the fine slot at the cursor only holds flows due now
+Flow* FlowWheel::expire(long now)
+{
+    if ( !count and now > cursor )
+        cursor = now;
+
+    while ( count and cursor <= now )
+    {
+        if ( Flow* flow = slots[cursor & slot_mask] )
+        {
+            assert(flow->wheel_time <= cursor);
+            remove(flow);
+            return flow;
+        }
+
+        if ( !(++cursor & slot_mask) )
+            cascade();
+    }
+    return nullptr;
+}
+
+//-------------------------------------------------------------------------
+// unit tests
+//-------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+TEST_CASE("flow wheel", "[flow]")
+{
+    FlowWheel fw;
+    Flow flows[4];
+
+    SECTION("in order")
+    {
+        fw.add(flows + 0, 100);
+        fw.add(flows + 1, 102);
+        fw.add(flows + 2, 101);
+
+        CHECK(fw.expire(99) == nullptr);
+        CHECK(fw.expire(100) == flows + 0);
+        CHECK(fw.expire(100) == nullptr);
+        CHECK(fw.expire(105) == flows + 2);
+        CHECK(fw.expire(105) == flows + 1);
+        CHECK(fw.expire(105) == nullptr);
+        CHECK(fw.get_count() == 0);
+    }
+
+    SECTION("later revolution")
+    {
+        fw.add(flows + 0, 100);
+        fw.add(flows + 1, 100 + FlowWheel::num_slots);
+
+        CHECK(fw.expire(100) == flows + 0);
+        CHECK(fw.expire(101) == nullptr);
+        CHECK(fw.get_count() == 1);
+        CHECK(fw.expire(100 + FlowWheel::num_slots) == flows + 1);
+    }
+
+    SECTION("coarse level")
+    {
+        const long wrap = FlowWheel::num_slots * FlowWheel::num_coarse;
+
+        fw.add(flows + 0, 100);
+        fw.add(flows + 1, 100 + 3600);
+        fw.add(flows + 2, 100 + wrap + 5);
+        fw.add(flows + 3, 101);
+
+        CHECK(fw.expire(100) == flows + 0);
+        fw.remove(flows + 3);
+
+        CHECK(fw.expire(100 + 3599) == nullptr);
+        CHECK(fw.expire(100 + 3600) == flows + 1);
+
+        CHECK(fw.expire(100 + wrap + 4) == nullptr);
+        CHECK(fw.get_count() == 1);
+        CHECK(fw.expire(100 + wrap + 5) == flows + 2);
+        CHECK(fw.get_count() == 0);
+    }
+
+    SECTION("remove")
+    {
+        fw.add(flows + 0, 100);
+        fw.add(flows + 1, 100);
+        fw.add(flows + 2, 100);
+
+        fw.remove(flows + 1);
+        CHECK(fw.get_count() == 2);
+
+        fw.remove(flows + 1);
+        CHECK(fw.get_count() == 2);
+
+        Flow* a = fw.expire(200);
+        Flow* b = fw.expire(200);
+        CHECK(((a == flows + 0 and b == flows + 2) or (a == flows + 2 and b == flows + 0)));
+        CHECK(fw.expire(200) == nullptr);
+    }
+
+    SECTION("past due")
+    {
+        fw.add(flows + 0, 100);
+        CHECK(fw.expire(110) == flows + 0);
+
+        fw.add(flows + 1, 150);
+        fw.add(flows + 2, 50);
+        CHECK(fw.expire(120) == flows + 2);
+        CHECK(fw.expire(120) == nullptr);
+        CHECK(fw.expire(150) == flows + 1);
+    }
+
+    SECTION("remove after expire")
+    {
+        fw.add(flows + 0, 100);
+        fw.add(flows + 1, 100);
+        fw.add(flows + 2, 100);
+
+        Flow* f = fw.expire(100);
+        fw.remove(f);
+        CHECK(fw.get_count() == 2);
+
+        CHECK(fw.expire(100) != nullptr);
+        CHECK(fw.expire(100) != nullptr);
+        CHECK(fw.expire(100) == nullptr);
+    }
+}
+
+#endif
@@ -0,0 +1,69 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// flow_wheel.h
+
+#ifndef FLOW_WHEEL_H
+#define FLOW_WHEEL_H
+
+// FlowWheel is a two level timing wheel that schedules flow timeouts for a
+// FlowCache.  flows due within one revolution (num_slots seconds) of the
+// cursor are bucketed by second; later ones are bucketed by revolution on
+// the coarse level and move down when their revolution starts.  flows more
+// than num_coarse revolutions (about 9 hours) out wrap around the coarse
+// level and are just put back each time their slot comes up.  so with
+// long timeouts (eg 3600 seconds for tcp) a fine slot only holds flows
+// that are due and expiring costs O(expired) plus one move per flow per
+// level rather than a walk of the lru list.
+//
+// flows are not moved when they see traffic; instead the cache checks a
+// flow when it comes due and reschedules it if it has been active since.
+
+#include <ctime>
+
+class Flow;
+
+class FlowWheel
+{
+public:
+    FlowWheel();
+
+    void add(Flow*, long when);
+    void remove(Flow*);  // no-op if not scheduled
+
+    // removes and returns a flow scheduled at or before now or nullptr
+    Flow* expire(long now);
+
+    unsigned get_count() const
+    { return count; }
+
+    static const unsigned num_slots = 512;  // power of 2
+    static const unsigned num_coarse = 64;  // power of 2
+
+private:
+    Flow** get_slot(long when);
+    void link(Flow*, Flow**);
+    void cascade();
+
+private:
+    Flow* slots[num_slots];
+    Flow* coarse[num_coarse];
+    long cursor;
+    unsigned count;
+};
+
+#endif
@@ -34,7 +34,11 @@
 #include "stream/stream.h"
 #include "time/packet_time.h"
 
-static const uint8_t HA_MESSAGE_VERSION = 3;
+static const uint8_t HA_MESSAGE_VERSION = 4;
+
+// update and delete records are batched into side channel messages of
+// up to this size; larger records go out in a message of their own
+static const uint32_t HA_BATCH_SIZE = MAXIMUM_SC_MESSAGE_CONTENT;
 
 // define message size and content constants.
 static const uint8_t KEY_SIZE_IP6 = sizeof(FlowKey);
@@ -51,7 +55,7 @@ enum
 
 typedef std::array<FlowHAClient*, MAX_CLIENTS> ClientMap;
 
-THREAD_LOCAL SimpleStats ha_stats;
+THREAD_LOCAL HAStats ha_stats;
 THREAD_LOCAL ProfileStats ha_perf_stats;
 
 static THREAD_LOCAL HighAvailability* ha;
@@ -204,6 +208,17 @@ bool FlowHAClient::place(HAMessage* msg, uint8_t* data, uint8_t length)
         return false;
 }
 
+// Size of the key that follows the header for the given key type
+static inline uint8_t key_type_size(uint8_t key_type)
+{
+    switch ( key_type )
+    {
+    case KEY_TYPE_IP6: return KEY_SIZE_IP6;
+    case KEY_TYPE_IP4: return KEY_SIZE_IP4;
+    default: return 0;
+    }
+}
+
 // Write the key type, key length, and key into the message.
 // Does not use the message cursor coming in.
 // Leave the message cursor just after the key. Return
@@ -403,6 +418,8 @@ static void consume_receive_message(HAMessage* msg)
     if ( hdr->version != HA_MESSAGE_VERSION)
         return;
 
+    ha_stats.msgs_received++;
+
     switch ( hdr->event )
     {
         case HA_DELETE_EVENT:
@@ -461,6 +478,7 @@ HighAvailability::~HighAvailability()
 
     if ( sc )
     {
+        flush();
         sc->unregister_receive_handler();
     }
 
@@ -477,12 +495,84 @@ void HighAvailability::receive_handler(SCMessage* sc_msg)
     // SC received messages must have reference back to SideChannel object
     assert(sc_msg->sc);
 
-    HAMessage ha_msg(sc_msg);
-    consume_receive_message(&ha_msg);
+    // replay every record in the batch
+    uint8_t* rec = sc_msg->content;
+    uint32_t left = sc_msg->content_length;
+
+    while ( left >= sizeof(HAMessageHeader) )
+    {
+        HAMessageHeader* hdr = (HAMessageHeader*)rec;
+        uint8_t key_len = key_type_size(hdr->key_type);
+
+        if ( (hdr->version != HA_MESSAGE_VERSION) || !key_len )
+            break;
+
+        uint32_t len = sizeof(HAMessageHeader) + key_len + hdr->total_length;
+
+        if ( len > left )
+        {
+            ErrorMessage("Consuming HA message - record too long\n");
+            break;
+        }
+
+        HAMessage ha_msg(rec, (uint16_t)len);
+        consume_receive_message(&ha_msg);
+
+        rec += len;
+        left -= len;
+    }
 
+    ha_stats.batches_received++;
     sc_msg->sc->discard_message(sc_msg);
 }
 
+// records are written straight into the current batch.  a batch is sent
+// when the next record won't fit, once it has been open for the minimum
+// sync interval, and whenever the packet thread idles or exits.
+uint8_t* HighAvailability::reserve(uint16_t length)
+{
+    if ( batch && (batch_used + length > batch->content_length) )
+        flush();
+
+    if ( !batch )
+    {
+        uint32_t size = (length > HA_BATCH_SIZE) ? length : HA_BATCH_SIZE;
+
+        if ( !(batch = sc->alloc_transmit_message(size)) )
+            return nullptr;
+
+        batch_used = 0;
+        packet_gettimeofday(&batch_start);
+    }
+
+    uint8_t* rec = batch->content + batch_used;
+    batch_used += length;
+    return rec;
+}
+
+void HighAvailability::flush()
+{
+    if ( !batch )
+        return;
+
+    sc->set_message_length(batch, batch_used);
+    sc->transmit_message(batch);
+    batch = nullptr;
+
+    ha_stats.batches_sent++;
+}
+
+static bool batch_expired(const struct timeval& start)
+{
+    struct timeval now, end;
+    const struct timeval& interval = FlowHAState::get_min_sync_interval();
+
+    packet_gettimeofday(&now);
+    timeradd(&start, &interval, &end);
+
+    return !timercmp(&now, &end, <);
+}
+
 void HighAvailability::process_update(Flow* flow, const DAQ_PktHdr_t* pkthdr)
 {
     DebugMessage(DEBUG_HA,"HighAvailability::process_update()\n");
@@ -496,21 +586,34 @@ void HighAvailability::process_update(Flow* flow, const DAQ_PktHdr_t* pkthdr)
     assert(s_client_map);
     assert((*s_client_map)[0]);
 
-    if ( !(*s_client_map)[0]->is_update_required(flow) &&
-        ( !flow->ha_state->check_pending(ALL_CLIENTS) ||
-            flow->ha_state->check_any(FlowHAState::NEW) ) )
-        return;
+    if ( !(*s_client_map)[0]->is_update_required(flow) )
+    {
+        // other clients are held to the sync interval too
+        if ( !flow->ha_state->check_pending(ALL_CLIENTS) ||
+            flow->ha_state->check_any(FlowHAState::NEW) )
+            return;
+
+        if ( !flow->ha_state->check_any(FlowHAState::CRITICAL) &&
+            !flow->ha_state->sync_interval_elapsed() )
+            return;
+    }
 
     const uint16_t header_len = calculate_msg_header_length(flow);
     const uint16_t content_len = calculate_update_msg_content_length(flow);
 
-    SCMessage* sc_msg = sc->alloc_transmit_message((uint32_t)(header_len+content_len));
-    assert(sc_msg);
-    HAMessage ha_msg(sc_msg);
+    uint8_t* rec = reserve(header_len + content_len);
+
+    if ( !rec )
+        return;
+
+    HAMessage ha_msg(rec, header_len + content_len);
 
     write_msg_header(flow, HA_UPDATE_EVENT, content_len, &ha_msg);
     write_update_msg_content(flow, &ha_msg);
-    sc->transmit_message(sc_msg);
+    ha_stats.update_msgs_sent++;
+
+    if ( batch_expired(batch_start) )
+        flush();
 
     flow->ha_state->clear(FlowHAState::NEW | FlowHAState::MODIFIED |
         FlowHAState::MAJOR | FlowHAState::CRITICAL);
@@ -533,16 +636,22 @@ void HighAvailability::process_deletion(Flow* flow)
     if ( !sc )
         return;
 
-    const uint32_t msg_len = calculate_msg_header_length(flow);
-    SCMessage* sc_msg = sc->alloc_transmit_message(msg_len);
-    HAMessage ha_msg(sc_msg);
+    const uint16_t msg_len = calculate_msg_header_length(flow);
+    uint8_t* rec = reserve(msg_len);
+
+    if ( !rec )
+        return;
+
+    HAMessage ha_msg(rec, msg_len);
 
     // No content, only header+key
     write_msg_header(flow, HA_DELETE_EVENT, 0, &ha_msg);
-
-    sc->transmit_message(sc_msg);
+    ha_stats.delete_msgs_sent++;
 
     flow->ha_state->add(FlowHAState::DELETED);
+
+    if ( batch_expired(batch_start) )
+        flush();
 }
 
 void HighAvailability::process_receive()
@@ -621,6 +730,13 @@ void HighAvailabilityManager::process_receive()
         ha->process_receive();
 }
 
+// Called in the packet threads to send the pending batch, if any
+void HighAvailabilityManager::flush()
+{
+    if ( ha != nullptr )
+        ha->flush();
+}
+
 // Called in the packet threads to determine whether or not HA is active
 bool HighAvailabilityManager::active()
 {
@@ -72,6 +72,8 @@ public:
     void clear(uint8_t state);
     bool check_any(uint8_t state);
     static void config_timers(timeval,timeval);
+    static const struct timeval& get_min_sync_interval()
+    { return min_sync_interval; }
     bool sync_interval_elapsed();
     void set_next_update();
     void reset();
@@ -101,22 +103,24 @@ struct __attribute__((__packed__)) HAClientHeader
     uint8_t length;
 };
 
-// Describe the message being produced or consumed.
+// Describe the message being produced or consumed.  This is a view of
+// one record; several records are batched in each side channel message.
 class HAMessage
 {
 public:
-    HAMessage(SCMessage* msg)
-    { sc_msg = msg; }
+    HAMessage(uint8_t* buf, uint16_t len)
+    { buffer = buf; buffer_length = len; cursor = buf; }
     ~HAMessage() { }
 
     uint8_t* content()
-    { return sc_msg->content; }
+    { return buffer; }
     uint16_t content_length()
-    { return sc_msg->content_length; }
+    { return buffer_length; }
     uint8_t* cursor;
 
 private:
-    SCMessage* sc_msg;
+    uint8_t* buffer;
+    uint16_t buffer_length;
 };
 
 // A FlowHAClient subclass for each producer/consumer of flow HA data
@@ -151,10 +155,18 @@ public:
     void process_update(Flow*, const DAQ_PktHdr_t*);
     void process_deletion(Flow*);
     void process_receive();
+    void flush();
 
 private:
     void receive_handler(SCMessage*);
+    uint8_t* reserve(uint16_t length);
+
     SideChannel* sc = nullptr;
+
+    // records are written directly into the current batch message
+    SCMessage* batch = nullptr;
+    uint32_t batch_used = 0;
+    struct timeval batch_start;
 };
 
 // Top level management of HighAvailability components.
@@ -181,6 +193,9 @@ public:
 
     // Look for and dispatch receive messages.
     static void process_receive();
+
+    // Transmit any batched messages now
+    static void flush();
     static void set_modified(Flow*);
     static bool in_standby(Flow*);
 
@@ -29,10 +29,13 @@
 
 static const PegInfo ha_pegs[] =
 {
+    { "update msgs sent", "flow update records sent" },
+    { "delete msgs sent", "flow delete records sent" },
+    { "batches sent", "side channel messages sent" },
+    { "msgs received", "update and delete records received" },
+    { "batches received", "side channel messages received" },
     { nullptr, nullptr }
 };
-
-extern THREAD_LOCAL SimpleStats ha_stats;
 extern THREAD_LOCAL ProfileStats ha_perf_stats;
 
 //-------------------------------------------------------------------------
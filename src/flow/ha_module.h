@@ -36,7 +36,16 @@ struct HighAvailabilityConfig
     struct timeval min_sync_interval;
 };
 
-extern THREAD_LOCAL SimpleStats ha_stats;
+struct HAStats
+{
+    PegCount update_msgs_sent;
+    PegCount delete_msgs_sent;
+    PegCount batches_sent;
+    PegCount msgs_received;
+    PegCount batches_received;
+};
+
+extern THREAD_LOCAL HAStats ha_stats;
 extern THREAD_LOCAL ProfileStats ha_perf_stats;
 
 class HighAvailabilityModule : public Module
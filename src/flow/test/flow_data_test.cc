@@ -0,0 +1,151 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+
+// flow_data_test.cc
+
+#include "flow/flow.h"
+
+#include "flow/ha.h"
+#include "framework/inspector.h"
+#include "protocols/layer.h"
+
+#include <CppUTest/CommandLineTestRunner.h>
+#include <CppUTest/TestHarness.h>
+
+//-------------------------------------------------------------------------
+// stubs
+//-------------------------------------------------------------------------
+
+THREAD_LOCAL unsigned Inspector::slot = 0;
+
+FlowHAState::FlowHAState() { }
+void FlowHAState::reset() { }
+bool HighAvailabilityManager::active() { return false; }
+
+namespace layer
+{
+const Layer* get_mpls_layer(const Packet*) { return nullptr; }
+bool set_outer_ip_api(const Packet*, ip::IpApi&, int8_t&) { return false; }
+}
+
+namespace ip
+{
+uint8_t IpApi::ttl() const { return 0; }
+}
+
+//-------------------------------------------------------------------------
+// fixtures
+//-------------------------------------------------------------------------
+
+static unsigned s_deleted = 0;
+static unsigned s_handled = 0;
+
+class TestData : public FlowData
+{
+public:
+    TestData(unsigned id) : FlowData(id) { }
+    ~TestData() { ++s_deleted; }
+
+    void handle_eof(Packet*) override
+    { ++s_handled; }
+};
+
+//-------------------------------------------------------------------------
+// tests
+//-------------------------------------------------------------------------
+
+TEST_GROUP(flow_data_test)
+{
+    Flow* flow;
+
+    void setup()
+    {
+        flow = new Flow;
+        s_deleted = s_handled = 0;
+    }
+
+    void teardown()
+    {
+        flow->free_flow_data();
+        delete flow;
+    }
+};
+
+TEST(flow_data_test, get_set)
+{
+    CHECK(!flow->get_flow_data(1));
+
+    TestData* fd = new TestData(1);
+    flow->set_flow_data(fd);
+    CHECK(flow->get_flow_data(1) == fd);
+    CHECK(!flow->get_flow_data(2));
+
+    TestData* fd2 = new TestData(1);
+    flow->set_flow_data(fd2);
+    CHECK(s_deleted == 1);
+    CHECK(flow->get_flow_data(1) == fd2);
+}
+
+TEST(flow_data_test, shared_slot)
+{
+    const unsigned n = Flow::flow_data_slots;
+    TestData* a = new TestData(3);
+    TestData* b = new TestData(3 + n);
+    TestData* c = new TestData(3 + 2 * n);
+
+    flow->set_flow_data(a);
+    flow->set_flow_data(b);
+    flow->set_flow_data(c);
+
+    CHECK(flow->get_flow_data(3) == a);
+    CHECK(flow->get_flow_data(3 + n) == b);
+    CHECK(flow->get_flow_data(3 + 2 * n) == c);
+    CHECK(!flow->get_flow_data(3 + 3 * n));
+
+    flow->free_flow_data(3);
+    CHECK(!flow->get_flow_data(3));
+    CHECK(flow->get_flow_data(3 + n) == b);
+    CHECK(flow->get_flow_data(3 + 2 * n) == c);
+
+    flow->free_flow_data(b);
+    flow->free_flow_data(c);
+    CHECK(!flow->get_flow_data(3 + n));
+    CHECK(!flow->get_flow_data(3 + 2 * n));
+    CHECK(!flow->flow_data);
+    CHECK(s_deleted == 3);
+}
+
+TEST(flow_data_test, handlers_and_free_all)
+{
+    for ( unsigned id = 1; id <= 20; ++id )
+        flow->set_flow_data(new TestData(id));
+
+    flow->call_handlers(nullptr, true);
+    CHECK(s_handled == 20);
+
+    flow->free_flow_data();
+    CHECK(s_deleted == 20);
+
+    for ( unsigned id = 1; id <= 20; ++id )
+        CHECK(!flow->get_flow_data(id));
+}
+
+int main(int argc, char** argv)
+{
+    return CommandLineTestRunner::RunAllTests(argc, argv);
+}
@@ -28,7 +28,7 @@
 #include <CppUTest/CommandLineTestRunner.h>
 #include <CppUTest/TestHarness.h>
 
-#define MSG_SIZE 100
+#define MSG_SIZE MAXIMUM_SC_MESSAGE_CONTENT
 #define TEST_KEY 0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17,18,19,20,21,22,23,24,25,26,27,28,29,30,31,32,33,34,35,36,37,38,39,40,41,42,43,44,45,46,47
 
 class StreamHAClient;
@@ -41,7 +41,7 @@ TEST_KEY
 static const uint8_t s_delete_message[] =
 {
     0x01,
-    0x03,
+    0x04,
     0x00,
     0x00,
     0x01,
@@ -51,8 +51,27 @@ TEST_KEY
 static const uint8_t s_update_stream_message[] =
 {
     0x02,
-    0x03,
+    0x04,
+    0x0c,
     0x00,
+    0x01,
+TEST_KEY,
+    0x00,
+    10,
+    0, 1, 2, 3, 4, 5, 6, 7, 8, 9
+};
+
+static const uint8_t s_batch_message[] =
+{
+    0x01,
+    0x04,
+    0x00,
+    0x00,
+    0x01,
+TEST_KEY,
+    0x02,
+    0x04,
+    0x0c,
     0x00,
     0x01,
 TEST_KEY,
@@ -75,7 +94,7 @@ static bool s_transmit_message_called = false;
 static bool s_stream_update_required = false;
 static bool s_other_update_required = false;
 static uint8_t* s_message_content = nullptr;
-static uint8_t s_message_length = 0;
+static uint32_t s_message_length = 0;
 static Flow s_flow;
 static FlowKey s_flowkey;
 static DAQ_PktHdr_t s_pkthdr;
@@ -170,6 +189,9 @@ Connector::Direction SideChannel::get_direction()
 
 void SideChannel::set_default_port(SCPort) { }
 
+void SideChannel::set_message_length(SCMessage* msg, uint32_t len)
+{ msg->content_length = len; }
+
 void SideChannel::register_receive_handler(std::function<void (SCMessage*)> handler)
 {
     s_handler = handler;
@@ -358,10 +380,35 @@ TEST(high_availability_test, receive_update_stream_only)
     CHECK(memcmp((const void*)&s_flowkey, (const void*)&s_test_key, sizeof(s_test_key)) == 0);
 }
 
+TEST(high_availability_test, transmit_update_batch)
+{
+    s_transmit_message_called = false;
+    s_stream_update_required = true;
+    s_other_update_required = false;
+    HighAvailabilityManager::process_update(&s_flow, &s_pkthdr);
+    HighAvailabilityManager::process_update(&s_flow, &s_pkthdr);
+    CHECK(s_transmit_message_called == false);
+    HighAvailabilityManager::flush();
+    CHECK(s_transmit_message_called == true);
+    CHECK(s_message_length == 2 * sizeof(s_update_stream_message));
+}
+
+TEST(high_availability_test, receive_batch)
+{
+    s_delete_session_called = false;
+    s_stream_consume_called = false;
+    s_message_content = (uint8_t*)s_batch_message;
+    s_message_length = sizeof(s_batch_message);
+    HighAvailabilityManager::process_receive();
+    CHECK(s_delete_session_called == true);
+    CHECK(s_stream_consume_called == true);
+}
+
 TEST(high_availability_test, transmit_deletion)
 {
     s_transmit_message_called = false;
     HighAvailabilityManager::process_deletion(&s_flow);
+    HighAvailabilityManager::flush();
     CHECK(s_transmit_message_called == true);
 }
 
@@ -371,6 +418,7 @@ TEST(high_availability_test, transmit_update_no_update)
     s_stream_update_required = false;
     s_other_update_required = false;
     HighAvailabilityManager::process_update(&s_flow, &s_pkthdr);
+    HighAvailabilityManager::flush();
     CHECK(s_transmit_message_called == false);
 }
 
@@ -380,6 +428,7 @@ TEST(high_availability_test, transmit_update_stream_only)
     s_stream_update_required = true;
     s_other_update_required = false;
     HighAvailabilityManager::process_update(&s_flow, &s_pkthdr);
+    HighAvailabilityManager::flush();
     CHECK(s_transmit_message_called == true);
 }
 
@@ -391,6 +440,7 @@ TEST(high_availability_test, transmit_update_both_update)
     CHECK(s_other_ha_client->handle == 1);
     s_flow.ha_state->set_pending(s_other_ha_client->handle);
     HighAvailabilityManager::process_update(&s_flow, &s_pkthdr);
+    HighAvailabilityManager::flush();
     CHECK(s_transmit_message_called == true);
 }
 
@@ -36,7 +36,7 @@
 #include "search_engines/search_common.h"
 
 // this is the current version of the api
-#define SEAPI_VERSION ((BASE_API_VERSION << 16) | 0)
+#define SEAPI_VERSION ((BASE_API_VERSION << 16) | 1)
 
 struct SnortConfig;
 struct MpseApi;
@@ -69,6 +69,14 @@ public:
 
     virtual int prep_patterns(SnortConfig*) = 0;
 
+    // engines may split prep_patterns() into compile(), which must only
+    // touch this instance so that many instances can be compiled in
+    // parallel, and finish(), which runs on the main thread and does the
+    // rest (agent callbacks, summary stats, and error reporting).
+    virtual bool can_compile_parallel() { return false; }
+    virtual int compile() { return -1; }
+    virtual int finish(SnortConfig*) { return -1; }
+
     int search(
         const uint8_t* T, int n, MpseMatch, void* context, int* current_state);
 
@@ -19,6 +19,11 @@
 
 #include "hashes.h"
 
+#ifdef UNIT_TEST
+#include <string.h>
+#include "catch/catch.hpp"
+#endif
+
 void sha256(const unsigned char* data, size_t size, unsigned char* digest)
 {
     SHA256_CTX c;
@@ -43,3 +48,61 @@ void md5(const unsigned char* data, size_t size, unsigned char* digest)
     MD5_Final(digest, &c);
 }
 
+Sha256::Sha256()
+{
+    ctx = EVP_MD_CTX_create();
+}
+
+Sha256::~Sha256()
+{
+    if ( ctx )
+        EVP_MD_CTX_destroy(ctx);
+}
+
+bool Sha256::init()
+{
+    ok = ctx && EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr) == 1;
+    return ok;
+}
+
+void Sha256::update(const uint8_t* data, size_t size)
+{
+    if ( ok )
+        ok = EVP_DigestUpdate(ctx, data, size) == 1;
+}
+
+bool Sha256::final(uint8_t* digest)
+{
+    if ( !ok )
+        return false;
+
+    ok = false;
+    return EVP_DigestFinal_ex(ctx, digest, nullptr) == 1;
+}
+
+#ifdef UNIT_TEST
+TEST_CASE("sha256 incremental", "[hashes]")
+{
+    const char* data = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+    size_t len = strlen(data);
+
+    uint8_t expected[SHA256_HASH_SIZE];
+    sha256((const unsigned char*)data, len, expected);
+
+    Sha256 ctx;
+    uint8_t digest[SHA256_HASH_SIZE];
+
+    // split at every position and reuse the same context each time
+    for ( size_t split = 0; split <= len; ++split )
+    {
+        REQUIRE(ctx.init());
+        ctx.update((const uint8_t*)data, split);
+        ctx.update((const uint8_t*)data + split, len - split);
+        REQUIRE(ctx.final(digest));
+        CHECK(!memcmp(digest, expected, sizeof(digest)));
+    }
+
+    // final consumes the digest; another needs init
+    CHECK(!ctx.final(digest));
+}
+#endif
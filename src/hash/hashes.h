@@ -24,8 +24,10 @@
 #include "config.h"
 #endif
 
+#include <openssl/evp.h>
 #include <openssl/md5.h>
 #include <openssl/sha.h>
+#include <stdint.h>
 #include <stdlib.h>
 
 #include "main/snort_types.h"
@@ -40,5 +42,32 @@ SO_PUBLIC void md5(const unsigned char* data, size_t size, unsigned char* digest
 SO_PUBLIC void sha256(const unsigned char* data, size_t size, unsigned char* digest);
 SO_PUBLIC void sha512(const unsigned char* data, size_t size, unsigned char* digest);
 
+// incremental sha256 for data that arrives in pieces (eg file signatures).
+// this goes through the openssl EVP interface, which is the supported one
+// (the SHA256_* calls are deprecated in newer openssl) and also honors a
+// configured engine.  the digest context is allocated once and reused by
+// init() so hashing a file needs no allocation.  if the context can't be
+// allocated or initialized, update() does nothing and final() fails.
+class SO_PUBLIC Sha256
+{
+public:
+    Sha256();
+    ~Sha256();
+
+    // owns the context
+    Sha256(const Sha256&) = delete;
+    Sha256& operator=(const Sha256&) = delete;
+
+    bool init();
+    void update(const uint8_t* data, size_t size);
+
+    // digest must be SHA256_HASH_SIZE bytes
+    bool final(uint8_t* digest);
+
+private:
+    EVP_MD_CTX* ctx;
+    bool ok = false;
+};
+
 #endif
 
@@ -310,6 +310,12 @@ int SetByteExtractValue(uint32_t value, int8_t var_number)
     return 0;
 }
 
+void GetByteExtractValues(uint32_t* dst)
+{ memcpy(dst, extracted_values, sizeof(extracted_values)); }
+
+void SetByteExtractValues(const uint32_t* src)
+{ memcpy(extracted_values, src, sizeof(extracted_values)); }
+
 //-------------------------------------------------------------------------
 // api
 //-------------------------------------------------------------------------
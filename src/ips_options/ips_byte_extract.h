@@ -35,5 +35,9 @@ SO_PUBLIC int8_t GetVarByName(const char* name);
 SO_PUBLIC int GetByteExtractValue(uint32_t* dst, int8_t var_number);
 SO_PUBLIC int SetByteExtractValue(uint32_t value, int8_t var_number);
 
+// save and restore all NUM_BYTE_EXTRACT_VARS values at once
+SO_PUBLIC void GetByteExtractValues(uint32_t* dst);
+SO_PUBLIC void SetByteExtractValues(const uint32_t* src);
+
 #endif
 
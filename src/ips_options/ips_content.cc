@@ -69,6 +69,7 @@ struct ContentData
 
     int* skip_stride;       /* B-M skip array */
     int* shift_stride;      /* B-M shift array */
+    bool use_bm;            /* else mSearchShort */
 
     void init();
     void setup_bm();
@@ -81,8 +82,16 @@ void ContentData::init()
     depth_var = BYTE_EXTRACT_NO_VAR;
 }
 
+// short patterns don't skip far enough for Boyer-Moore to win
+#define MAX_SHORT_PATTERN 32
+
 void ContentData::setup_bm()
 {
+    use_bm = pmd.pattern_size > MAX_SHORT_PATTERN;
+
+    if ( !use_bm )
+        return;
+
     skip_stride = make_skip(pmd.pattern_buf, pmd.pattern_size);
     shift_stride = make_shift(pmd.pattern_buf, pmd.pattern_size);
 }
@@ -162,7 +171,7 @@ ContentOption::~ContentOption()
         snort_free((char*)cd->pmd.pattern_buf);
 
     if ( cd->pmd.last_check )
-        snort_free(cd->pmd.last_check);
+        snort_free_aligned(cd->pmd.last_check);
 
     if ( cd->skip_stride )
         snort_free(cd->skip_stride);
@@ -360,7 +369,16 @@ static int uniSearchReal(ContentData* cd, Cursor& c)
     const uint8_t* base = c.buffer() + pos;
     int found;
 
-    if ( cd->pmd.no_case )
+    if ( !cd->use_bm )
+    {
+        if ( cd->pmd.no_case )
+            found = mSearchShortCI(
+                (const char*)base, depth, cd->pmd.pattern_buf, cd->pmd.pattern_size);
+        else
+            found = mSearchShort(
+                (const char*)base, depth, cd->pmd.pattern_buf, cd->pmd.pattern_size);
+    }
+    else if ( cd->pmd.no_case )
     {
         found = mSearchCI(
             (const char*)base, depth, cd->pmd.pattern_buf, cd->pmd.pattern_size,
@@ -28,11 +28,17 @@
 #include <sys/types.h>
 #include <pcre.h>
 
+#ifdef HAVE_HYPERSCAN
+#include <hs_compile.h>
+#include <hs_runtime.h>
+#endif
+
 #include "log/messages.h"
 #include "main/snort_types.h"
 #include "main/snort_debug.h"
 #include "main/snort_config.h"
 #include "protocols/packet.h"
+#include "protocols/packet_manager.h"
 #include "parser/parser.h"
 #include "utils/util.h"
 #include "hash/sfhashfcn.h"
@@ -40,6 +46,7 @@
 #include "detection/treenodes.h"
 #include "detection/detection_defines.h"
 #include "detection/detection_util.h"
+#include "detection/fp_detect.h"
 #include "framework/cursor.h"
 #include "framework/ips_option.h"
 #include "framework/parameter.h"
@@ -73,6 +80,9 @@ struct PcreData
     bool free_pe;
     int options;        /* sp_pcre specfic options (relative & inverse) */
     char* expression;
+#ifdef HAVE_HYPERSCAN
+    hs_database_t* db;  /* prefilter; null if the regex can't be prefiltered */
+#endif
 };
 
 /*
@@ -95,6 +105,28 @@ static int s_ovector_size = 0;
 
 static THREAD_LOCAL ProfileStats pcrePerfStats;
 
+#ifdef HAVE_HYPERSCAN
+// prototype scratch for all prefilters; cloned per packet thread by
+// pcre_setup() just like ips_regex.cc does for its databases
+static hs_scratch_t* s_scratch = nullptr;
+
+// the prefilter result of the last buffer scanned by this thread.  retries
+// of a relative pcre evaluate the same buffer from later offsets so they
+// reuse the end of the last prefilter match instead of scanning again.
+// the buffer is identified the same way detection_options.cc identifies
+// the packet being evaluated.
+struct PrefilterScan
+{
+    const hs_database_t* db;
+    const uint8_t* buf;
+    int len;
+    uint64_t pkt;
+    long long last_end;  // -1 if no match
+};
+
+static THREAD_LOCAL PrefilterScan s_last_scan;
+#endif
+
 //-------------------------------------------------------------------------
 // implementation foo
 //-------------------------------------------------------------------------
@@ -161,6 +193,92 @@ static void pcre_check_anchored(PcreData* pcre_data)
     }
 }
 
+#ifdef HAVE_HYPERSCAN
+// a hyperscan prefilter matches at least everything the pcre matches (and
+// possibly more) so when the prefilter doesn't match the much slower
+// pcre_exec() can be skipped.  not every regex can be prefiltered; those
+// that can't are simply always run through pcre.
+static void pcre_prefilter(const char* re, int compile_flags, PcreData* pcre_data)
+{
+    // extended syntax isn't translated
+    if ( compile_flags & PCRE_EXTENDED )
+        return;
+
+    // anchoring, ungreedy, and dollar end only can only remove matches
+    unsigned flags = HS_FLAG_PREFILTER;
+
+    if ( compile_flags & PCRE_CASELESS )
+        flags |= HS_FLAG_CASELESS;
+
+    if ( compile_flags & PCRE_DOTALL )
+        flags |= HS_FLAG_DOTALL;
+
+    if ( compile_flags & PCRE_MULTILINE )
+        flags |= HS_FLAG_MULTILINE;
+
+    hs_compile_error_t* err = nullptr;
+
+    if ( hs_compile(re, flags, HS_MODE_BLOCK, nullptr, &pcre_data->db, &err)
+        or !pcre_data->db )
+    {
+        hs_free_compile_error(err);
+        pcre_data->db = nullptr;
+        return;
+    }
+
+    if ( hs_alloc_scratch(pcre_data->db, &s_scratch) != HS_SUCCESS )
+    {
+        hs_free_database(pcre_data->db);
+        pcre_data->db = nullptr;
+    }
+}
+
+// the whole buffer is scanned so that the result holds for any start
+// offset; only the end of the last match is kept
+static int hs_match(
+    unsigned int /*id*/, unsigned long long /*from*/, unsigned long long to,
+    unsigned int /*flags*/, void* context)
+{
+    long long& last_end = *(long long*)context;
+
+    if ( (long long)to > last_end )
+        last_end = to;
+
+    return 0;  // keep scanning
+}
+
+// pcre matches start at or after start_offset so they end there or later
+// and the prefilter reports a match with the same end.  the whole buffer
+// is scanned so that lookbehinds see what pcre sees.  returns false if
+// pcre can't match.
+static bool prefilter_match(
+    const hs_database_t* db, const uint8_t* buf, int len, int start_offset,
+    hs_scratch_t* scratch)
+{
+    PrefilterScan& s = s_last_scan;
+    uint64_t pkt = rule_eval_pkt_count + PacketManager::get_rebuilt_packet_count();
+
+    if ( s.db != db or s.buf != buf or s.len != len or s.pkt != pkt )
+    {
+        long long last_end = -1;
+
+        if ( hs_scan(db, (const char*)buf, len, 0, scratch, hs_match, &last_end)
+            != HS_SUCCESS )
+        {
+            s.db = nullptr;
+            return true;
+        }
+
+        s.db = db;
+        s.buf = buf;
+        s.len = len;
+        s.pkt = pkt;
+        s.last_end = last_end;
+    }
+    return s.last_end >= start_offset;
+}
+#endif
+
 static void pcre_parse(const char* data, PcreData* pcre_data)
 {
     const char* error;
@@ -341,6 +459,10 @@ static void pcre_parse(const char* data, PcreData* pcre_data)
     pcre_capture(pcre_data->re, pcre_data->pe);
     pcre_check_anchored(pcre_data);
 
+#ifdef HAVE_HYPERSCAN
+    pcre_prefilter(re, compile_flags, pcre_data);
+#endif
+
     snort_free(free_me);
     return;
 
@@ -391,6 +513,15 @@ static bool pcre_search(
     SnortState* ss = snort_conf->state + get_instance_id();
     assert(ss->pcre_ovector);
 
+#ifdef HAVE_HYPERSCAN
+    if ( pcre_data->db and ss->pcre_scratch and
+        !prefilter_match(pcre_data->db, buf, len, start_offset,
+        (hs_scratch_t*)ss->pcre_scratch) )
+    {
+        result = PCRE_ERROR_NOMATCH;
+    }
+    else
+#endif
     result = pcre_exec(
         pcre_data->re,  /* result of pcre_compile() */
         pcre_data->pe,  /* result of pcre_study()   */
@@ -499,6 +630,11 @@ PcreOption::~PcreOption()
     if ( config->re )
         free(config->re);  // external allocation
 
+#ifdef HAVE_HYPERSCAN
+    if ( config->db )
+        hs_free_database(config->db);
+#endif
+
     snort_free(config);
 }
 
@@ -641,6 +777,18 @@ void pcre_setup(SnortConfig* sc)
     {
         SnortState* ss = sc->state + i;
         ss->pcre_ovector = (int*)snort_calloc(s_ovector_max, sizeof(int));
+
+#ifdef HAVE_HYPERSCAN
+        // without a scratch the prefilters are skipped and pcre is used
+        ss->pcre_scratch = nullptr;
+
+        if ( s_scratch and
+            hs_clone_scratch(s_scratch, (hs_scratch_t**)&ss->pcre_scratch) != HS_SUCCESS )
+        {
+            ss->pcre_scratch = nullptr;
+            ErrorMessage("can't allocate pcre prefilter scratch, using pcre only\n");
+        }
+#endif
     }
 }
 
@@ -654,6 +802,14 @@ void pcre_cleanup(SnortConfig* sc)
             snort_free(ss->pcre_ovector);
 
         ss->pcre_ovector = nullptr;
+
+#ifdef HAVE_HYPERSCAN
+        if ( ss->pcre_scratch )
+        {
+            hs_free_scratch((hs_scratch_t*)ss->pcre_scratch);
+            ss->pcre_scratch = nullptr;
+        }
+#endif
     }
 }
 
@@ -743,6 +899,18 @@ static void pcre_dtor(IpsOption* p)
     delete p;
 }
 
+#ifdef HAVE_HYPERSCAN
+static void pcre_pterm(SnortConfig*)
+{
+    if ( s_scratch )
+        hs_free_scratch(s_scratch);
+
+    s_scratch = nullptr;
+}
+#else
+#define pcre_pterm nullptr
+#endif
+
 static void pcre_verify(SnortConfig* sc)
 {
     /* The pcre_fullinfo() function can be used to find out how many
@@ -777,7 +945,7 @@ static const IpsApi pcre_api =
     OPT_TYPE_DETECTION,
     0, 0,
     nullptr,
-    nullptr,
+    pcre_pterm,
     nullptr,
     nullptr,
     pcre_ctor,
@@ -0,0 +1,160 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// latency_histogram.cc
+
+#include "latency_histogram.h"
+
+#include <cstring>
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#ifdef UNIT_TEST
+#include "catch/catch.hpp"
+#endif
+
+// values below sub_buckets map 1:1; above that, the top sub_bits bits
+// below the most significant bit select the sub-bucket within the
+// magnitude range
+unsigned LatencyHistogram::get_bucket(uint64_t v)
+{
+    if ( v < sub_buckets )
+        return v;
+
+    unsigned msb = 63 - __builtin_clzll(v);
+    unsigned shift = msb - sub_bits;
+
+    return (shift + 1) * sub_buckets + (unsigned)((v >> shift) - sub_buckets);
+}
+
+uint64_t LatencyHistogram::get_value(unsigned b)
+{
+    if ( b < sub_buckets )
+        return b;
+
+    unsigned shift = b / sub_buckets - 1;
+    uint64_t lo = (uint64_t)(sub_buckets + b % sub_buckets) << shift;
+
+    return lo + ((uint64_t)1 << shift) - 1;
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& that)
+{
+    for ( unsigned i = 0; i < max_buckets; ++i )
+        buckets[i] += that.buckets[i];
+
+    total += that.total;
+}
+
+void LatencyHistogram::reset()
+{ memset(this, 0, sizeof(*this)); }
+
+uint64_t LatencyHistogram::get_percentile(double pct) const
+{
+    if ( !total )
+        return 0;
+
+    PegCount want = (PegCount)(pct * total / 100.0 + 0.5);
+
+    if ( !want )
+        want = 1;
+
+    PegCount sum = 0;
+
+    for ( unsigned i = 0; i < max_buckets; ++i )
+    {
+        sum += buckets[i];
+
+        if ( sum >= want )
+            return get_value(i);
+    }
+    return get_value(max_buckets - 1);
+}
+
+// -----------------------------------------------------------------------------
+// unit tests
+// -----------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+
+TEST_CASE ( "latency histogram buckets", "[latency]" )
+{
+    SECTION( "small values are exact" )
+    {
+        for ( uint64_t v = 0; v < LatencyHistogram::sub_buckets * 2; ++v )
+            CHECK( LatencyHistogram::get_value(LatencyHistogram::get_bucket(v)) == v );
+    }
+
+    SECTION( "buckets are monotonic and bounded" )
+    {
+        unsigned last = 0;
+
+        for ( uint64_t v = 1; v < ((uint64_t)1 << 40); v += v / 3 + 1 )
+        {
+            unsigned b = LatencyHistogram::get_bucket(v);
+            uint64_t hi = LatencyHistogram::get_value(b);
+
+            CHECK( b >= last );
+            CHECK( hi >= v );
+            CHECK( hi - v <= v / LatencyHistogram::sub_buckets );
+            last = b;
+        }
+    }
+
+    SECTION( "max value" )
+    {
+        CHECK( LatencyHistogram::get_bucket(UINT64_MAX) == LatencyHistogram::max_buckets - 1 );
+        CHECK( LatencyHistogram::get_value(LatencyHistogram::max_buckets - 1) == UINT64_MAX );
+    }
+}
+
+TEST_CASE ( "latency histogram percentiles", "[latency]" )
+{
+    static LatencyHistogram h;
+    h.reset();
+
+    CHECK( h.get_percentile(50.0) == 0 );
+
+    for ( uint64_t v = 1; v <= 1000; ++v )
+        h.add(v);
+
+    CHECK( h.total == 1000 );
+
+    uint64_t p50 = h.get_percentile(50.0);
+    CHECK( p50 >= 500 );
+    CHECK( p50 <= 500 + 500 / LatencyHistogram::sub_buckets );
+
+    uint64_t p99 = h.get_percentile(99.0);
+    CHECK( p99 >= 990 );
+    CHECK( p99 <= 990 + 990 / LatencyHistogram::sub_buckets );
+
+    SECTION( "merge" )
+    {
+        static LatencyHistogram g;
+        g.reset();
+        g.add(100000);
+        h.merge(g);
+
+        CHECK( h.total == 1001 );
+        CHECK( h.get_percentile(100.0) >= 100000 );
+        CHECK( h.get_percentile(50.0) == p50 );
+    }
+}
+
+#endif
@@ -0,0 +1,61 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// latency_histogram.h
+
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+// log-linear histogram of latencies in the style of HdrHistogram: each
+// power of two range is split into a fixed number of linear sub-buckets
+// so the relative error of a reported value is bounded (1/8 here) no
+// matter how large the value is.  the struct is POD so it can be
+// THREAD_LOCAL; threads record privately and totals are merged when
+// stats are summed.
+
+#include <cstdint>
+
+#include "framework/counts.h"
+
+struct LatencyHistogram
+{
+    static constexpr unsigned sub_bits = 3;
+    static constexpr unsigned sub_buckets = 1 << sub_bits;
+    static constexpr unsigned max_buckets = (64 - sub_bits + 1) * sub_buckets;
+
+    PegCount total;
+    PegCount buckets[max_buckets];
+
+    static unsigned get_bucket(uint64_t);
+
+    // largest value that maps into the given bucket
+    static uint64_t get_value(unsigned);
+
+    void add(uint64_t usecs)
+    {
+        ++buckets[get_bucket(usecs)];
+        ++total;
+    }
+
+    void merge(const LatencyHistogram&);
+    void reset();
+
+    // returns the value at or below which pct percent of samples fall
+    uint64_t get_percentile(double pct) const;
+};
+
+#endif
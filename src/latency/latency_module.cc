@@ -21,8 +21,10 @@
 #include "latency_module.h"
 
 #include <chrono>
+#include <string>
 
 #include "main/snort_config.h"
+#include "utils/stats.h"
 #include "latency_config.h"
 #include "latency_stats.h"
 #include "latency_rules.h"
@@ -92,6 +94,7 @@ static const RuleMap latency_rules[] =
 };
 
 THREAD_LOCAL LatencyStats latency_stats;
+THREAD_LOCAL LatencyHistograms latency_histograms;
 
 static const PegInfo latency_pegs[] =
 {
@@ -165,9 +168,36 @@ static inline bool latency_set(Value& v, RuleLatencyConfig& config)
     return true;
 }
 
+static void show_percentiles(const char* what, const LatencyHistogram& h)
+{
+    static const struct { const char* name; double pct; } pcts[] =
+    {
+        { "p50", 50.0 },
+        { "p90", 90.0 },
+        { "p99", 99.0 },
+        { "p99.9", 99.9 },
+        { "max", 100.0 }
+    };
+
+    if ( !h.total )
+        return;
+
+    for ( const auto& p : pcts )
+    {
+        std::string s = what;
+        s += " ";
+        s += p.name;
+        s += " usecs";
+        LogCount(s.c_str(), h.get_percentile(p.pct));
+    }
+}
+
 LatencyModule::LatencyModule() :
     Module(s_name, s_help, s_params)
-{ }
+{
+    totals.packet.reset();
+    totals.rule.reset();
+}
 
 bool LatencyModule::set(const char* fqn, Value& v, SnortConfig* sc)
 {
@@ -194,3 +224,34 @@ const PegInfo* LatencyModule::get_pegs() const
 
 PegCount* LatencyModule::get_counts() const
 { return reinterpret_cast<PegCount*>(&latency_stats); }
+
+void LatencyModule::sum_stats()
+{
+    // first call may reset_stats() so merge after
+    Module::sum_stats();
+
+    totals.packet.merge(latency_histograms.packet);
+    totals.rule.merge(latency_histograms.rule);
+
+    latency_histograms.packet.reset();
+    latency_histograms.rule.reset();
+}
+
+void LatencyModule::show_stats()
+{
+    Module::show_stats();
+
+    show_percentiles("packet", totals.packet);
+    show_percentiles("rule eval", totals.rule);
+}
+
+void LatencyModule::reset_stats()
+{
+    totals.packet.reset();
+    totals.rule.reset();
+
+    latency_histograms.packet.reset();
+    latency_histograms.rule.reset();
+
+    Module::reset_stats();
+}
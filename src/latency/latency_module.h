@@ -22,6 +22,7 @@
 #define LATENCY_MODULE_H
 
 #include "framework/module.h"
+#include "latency_stats.h"
 
 class LatencyModule : public Module
 {
@@ -35,6 +36,15 @@ public:
 
     const PegInfo* get_pegs() const override;
     PegCount* get_counts() const override;
+
+    void sum_stats() override;
+    void show_stats() override;
+    void reset_stats() override;
+
+private:
+    // threads merge their histograms here when stats are summed;
+    // ModuleManager serializes those calls
+    LatencyHistograms totals;
 };
 
 #endif
@@ -23,6 +23,7 @@
 
 #include "main/thread.h"
 #include "framework/counts.h"
+#include "latency_histogram.h"
 
 struct LatencyStats
 {
@@ -35,6 +36,13 @@ struct LatencyStats
     PegCount rule_tree_enables;
 };
 
+struct LatencyHistograms
+{
+    LatencyHistogram packet;
+    LatencyHistogram rule;
+};
+
 extern THREAD_LOCAL LatencyStats latency_stats;
+extern THREAD_LOCAL LatencyHistograms latency_histograms;
 
 #endif
@@ -251,6 +251,7 @@ void PacketLatency::pop(const Packet* p)
             latency_stats.max_usecs = elapsed;
 
         latency_stats.total_usecs += elapsed;
+        latency_histograms.packet.add(elapsed);
     }
 }
 
@@ -33,6 +33,7 @@
 #include "events/event_queue.h"
 #include "log/messages.h"
 #include "main/snort_config.h"
+#include "main/thread.h"
 #include "protocols/packet.h"
 #include "sfip/sf_ip.h"
 #include "utils/stats.h"
@@ -46,6 +47,7 @@
 #ifdef UNIT_TEST
 #include "catch/catch.hpp"
 #include "main/thread_config.h"
+#include "utils/util.h"
 #endif
 
 namespace rule_latency
@@ -193,7 +195,7 @@ public:
     Impl(const ConfigWrapper&, EventHandler&, EventHandler&);
 
     bool push(detection_option_tree_root_t*, Packet*);
-    bool pop();
+    bool pop(uint64_t& usecs);
     bool suspended() const;
 
 private:
@@ -232,7 +234,7 @@ inline bool Impl<Clock, RuleTree>::push(detection_option_tree_root_t* root, Pack
 }
 
 template<typename Clock, typename RuleTree>
-inline bool Impl<Clock, RuleTree>::pop()
+inline bool Impl<Clock, RuleTree>::pop(uint64_t& usecs)
 {
     assert(!timers.empty());
     const auto& timer = timers.back();
@@ -258,6 +260,10 @@ inline bool Impl<Clock, RuleTree>::pop()
         }
     }
 
+    using std::chrono::duration_cast;
+    using std::chrono::microseconds;
+    usecs = clock_usecs(duration_cast<microseconds>(timer.elapsed()).count());
+
     timers.pop_back();
     return timed_out;
 }
@@ -354,8 +360,12 @@ void RuleLatency::pop()
 {
     if ( rule_latency::config->enabled() )
     {
-        if ( rule_latency::get_impl().pop() )
+        uint64_t elapsed;
+
+        if ( rule_latency::get_impl().pop(elapsed) )
             ++latency_stats.rule_eval_timeouts;
+
+        latency_histograms.rule.add(elapsed);
     }
 }
 
@@ -540,6 +550,7 @@ TEST_CASE ( "rule latency impl", "[latency]" )
 
     SECTION( "pop" )
     {
+        uint64_t elapsed;
         config.config.max_time = 1_ticks;
 
         impl.push(&root, &pkt);
@@ -552,7 +563,7 @@ TEST_CASE ( "rule latency impl", "[latency]" )
             {
                 RuleInterfaceSpy::is_suspended_result = true;
 
-                CHECK_FALSE( impl.pop() );
+                CHECK_FALSE( impl.pop(elapsed) );
                 CHECK( log_handler.count == 0 );
                 CHECK( event_handler.count == 0 );
                 CHECK_FALSE( RuleInterfaceSpy::timeout_and_suspend_called );
@@ -563,7 +574,7 @@ TEST_CASE ( "rule latency impl", "[latency]" )
                 RuleInterfaceSpy::is_suspended_result = false;
                 RuleInterfaceSpy::timeout_and_suspend_result = true;
 
-                CHECK( impl.pop() );
+                CHECK( impl.pop(elapsed) );
                 CHECK( log_handler.count == 1 );
                 CHECK( event_handler.count == 1 );
                 CHECK( RuleInterfaceSpy::timeout_and_suspend_called );
@@ -573,7 +584,7 @@ TEST_CASE ( "rule latency impl", "[latency]" )
             {
                 RuleInterfaceSpy::timeout_and_suspend_result = false;
 
-                CHECK( impl.pop() );
+                CHECK( impl.pop(elapsed) );
                 CHECK( log_handler.count == 1 );
                 CHECK( event_handler.count == 1 );
                 CHECK( RuleInterfaceSpy::timeout_and_suspend_called );
@@ -586,7 +597,7 @@ TEST_CASE ( "rule latency impl", "[latency]" )
         {
             RuleInterfaceSpy::is_suspended_result = false;
 
-            CHECK_FALSE( impl.pop() );
+            CHECK_FALSE( impl.pop(elapsed) );
             CHECK( log_handler.count == 0 );
             CHECK( event_handler.count == 0 );
             CHECK_FALSE( RuleInterfaceSpy::timeout_and_suspend_called );
@@ -612,7 +623,10 @@ TEST_CASE ( "default latency rule interface", "[latency]" )
     detection_option_tree_node_t child;
     children[0] = &child;
 
-    std::unique_ptr<dot_node_state_t[]> child_state(new dot_node_state_t[instances]());
+    std::unique_ptr<dot_node_state_t[], void (*)(void*)> child_state(
+        (dot_node_state_t*)snort_calloc_aligned(
+        alignof(dot_node_state_t), instances, sizeof(dot_node_state_t)),
+        snort_free_aligned);
     child.state = child_state.get();
 
     detection_option_tree_root_t root;
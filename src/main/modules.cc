@@ -196,6 +196,9 @@ static const Parameter search_engine_params[] =
     { "bleedover_warnings_enabled", Parameter::PT_BOOL, nullptr, "false",
       "print warning if a rule is demoted to any-any port group" },
 
+    { "compile_threads", Parameter::PT_INT, "0:", "0",
+      "threads used to compile fast pattern groups at startup (0 means one per cpu)" },
+
     { "enable_single_rule_group", Parameter::PT_BOOL, nullptr, "false",
       "put all rules into one group" },
 
@@ -220,6 +223,9 @@ static const Parameter search_engine_params[] =
     { "max_queue_events", Parameter::PT_INT, nullptr, "5",
       "maximum number of matching fast pattern states to queue per packet" },
 
+    { "queue_limit", Parameter::PT_INT, "1:", "128",
+      "maximum number of unique fast pattern hits queued before rules are evaluated" },
+
     { "inspect_stream_inserts", Parameter::PT_BOOL, nullptr, "false",
       "inspect reassembled payload - disabling is good for performance, bad for detection" },
 
@@ -284,6 +290,9 @@ bool SearchEngineModule::set(const char*, Value& v, SnortConfig* sc)
         if ( v.get_bool() )
             fp->set_single_rule_group();
     }
+    else if ( v.is("compile_threads") )
+        fp->set_compile_threads(v.get_long());
+
     else if ( v.is("debug") )
     {
         if ( v.get_bool() )
@@ -315,6 +324,9 @@ bool SearchEngineModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("max_queue_events") )
         fp->set_max_queue_events(v.get_long());
 
+    else if ( v.is("queue_limit") )
+        fp->set_queue_limit(v.get_long());
+
     else if ( v.is("inspect_stream_inserts") )
         fp->set_stream_insert(v.get_bool());
 
@@ -357,6 +369,10 @@ static const Parameter profiler_time_params[] =
     { "max_depth", Parameter::PT_INT, "-1:", "-1",
       "limit depth to max_depth (-1 = no limit)" },
 
+    { "sample", Parameter::PT_INT, "0:1000000", "0",
+      "sample active modules every given usecs of cpu time instead of timing "
+      "each check (0 = off)" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
@@ -453,7 +469,14 @@ bool ProfilerModule::set(const char* fqn, Value& v, SnortConfig* sc)
     const char* spr = "profiler.rules";
 
     if ( !strncmp(fqn, spt, strlen(spt)) )
+    {
+        if ( v.is("sample") )
+        {
+            sc->profiler->time.sample = v.get_long();
+            return true;
+        }
         return s_profiler_module_set(sc->profiler->time, v);
+    }
 
     else if ( !strncmp(fqn, spm, strlen(spm)) )
         return s_profiler_module_set(sc->profiler->memory, v);
@@ -39,6 +39,7 @@
 #include "codecs/codec_api.h"
 #include "connectors/connectors.h"
 #include "decompress/file_decomp.h"
+#include "decompress/inflate_pool.h"
 #include "detection/detect.h"
 #include "detection/detection_util.h"
 #include "detection/fp_config.h"
@@ -67,6 +68,7 @@
 #include "managers/mpse_manager.h"
 #include "managers/plugin_manager.h"
 #include "managers/script_manager.h"
+#include "memory/memory_cache.h"
 #include "network_inspectors/network_inspectors.h"
 #include "packet_io/sfdaq.h"
 #include "packet_io/active.h"
@@ -512,11 +514,18 @@ void Snort::setup(int argc, char* argv[])
     keep_decomp_lib();
     keep_jsnorm_lib();
 
+    // interval timers are not inherited so this must follow daemonization
+    const TimeProfilerConfig& time_config = SnortConfig::get_profiler()->time;
+
+    if ( time_config.show && time_config.sample )
+        TimeSampler::start(time_config.sample);
+
     TimeStart();
 }
 
 void Snort::cleanup()
 {
+    TimeSampler::stop();
     TimeStop();
 
     SFDAQ::term();
@@ -629,6 +638,7 @@ void Snort::thread_idle()
     perf_monitor_idle_process();
     aux_counts.idle++;
     HighAvailabilityManager::process_receive();
+    HighAvailabilityManager::flush();
 }
 
 void Snort::thread_rotate()
@@ -729,9 +739,12 @@ void Snort::thread_term()
     EventTrace_Term();
     CleanupTag();
     FileService::thread_term();
+    InflatePool::thread_term();
 
     SnortEventqFree();
     Active::term();
+
+    memory::MemoryCache::thread_term();
 }
 
 void Snort::detect_rebuilt_packet(Packet* p)
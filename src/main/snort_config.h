@@ -136,6 +136,7 @@ struct SnortState
     void* regex_scratch;
     void* hyperscan_scratch;
     void* sdpattern_scratch;
+    void* pcre_scratch;
 };
 
 struct SnortConfig
@@ -36,6 +36,10 @@
 #    define THREAD_LOCAL __thread
 #endif
 
+// per packet thread state that is kept in arrays indexed by instance id is
+// aligned to this so that threads don't write to the same cache line
+#define CACHE_LINE_SIZE 64
+
 enum SThreadType
 {
     STHREAD_TYPE_PACKET,
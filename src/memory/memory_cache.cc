@@ -0,0 +1,397 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// memory_cache.cc
+
+#include "memory_cache.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <pthread.h>
+#include <sys/mman.h>
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <mutex>
+
+#include "memory_cap.h"
+#include "memory_module.h"
+
+#ifdef UNIT_TEST
+#include <thread>
+
+#include "catch/catch.hpp"
+#endif
+
+namespace memory
+{
+
+// -----------------------------------------------------------------------------
+// shared pool
+// -----------------------------------------------------------------------------
+
+// everything here is statically initialized because operator new may be
+// called before any constructors run
+
+namespace
+{
+
+struct Block
+{
+    Block* next;
+};
+
+struct Bin
+{
+    Block* head;
+    unsigned count;
+};
+
+const uint16_t s_class_size[MemoryCache::NUM_CLASSES + 1] =
+{
+    0, 16, 32, 48, 64, 80, 96, 112, 128,
+    160, 192, 224, 256, 320, 384, 448, 512, 640, 768, 896, 1024
+};
+
+// the arena is reserved up front but pages are only touched as slabs
+// are carved; once it is used up allocations go to the heap
+const unsigned SLAB_SHIFT = 16;
+const size_t SLAB_SIZE = (size_t)1 << SLAB_SHIFT;
+const size_t ARENA_SIZE = (size_t)1 << 30;
+const size_t NUM_SLABS = ARENA_SIZE >> SLAB_SHIFT;
+
+std::mutex s_lock;
+Block* s_pool[MemoryCache::NUM_CLASSES + 1];
+uint8_t s_slab_class[NUM_SLABS];
+
+uint8_t* s_base = nullptr;
+uint8_t* s_next = nullptr;
+std::atomic<uint8_t*> s_end { nullptr };
+bool s_no_arena = false;
+
+THREAD_LOCAL Bin s_bins[MemoryCache::NUM_CLASSES + 1];
+
+// every thread that caches blocks sets a key whose destructor returns them
+// at thread exit, so threads other than packet threads (compile workers,
+// file capture writers, the sampler, etc.) don't leak their bins
+pthread_once_t s_key_once = PTHREAD_ONCE_INIT;
+pthread_key_t s_exit_key;
+THREAD_LOCAL bool s_exit_set = false;
+
+void thread_exit(void*)
+{
+    s_exit_set = false;
+    MemoryCache::thread_term();
+}
+
+void make_exit_key()
+{ pthread_key_create(&s_exit_key, thread_exit); }
+
+inline void set_thread_exit()
+{
+    if ( s_exit_set )
+        return;
+
+    pthread_once(&s_key_once, make_exit_key);
+    pthread_setspecific(s_exit_key, &s_exit_set);
+    s_exit_set = true;
+}
+
+inline unsigned batch_count(unsigned c)
+{
+    unsigned n = 4096 / s_class_size[c];
+    return n < 4 ? 4 : (n > 32 ? 32 : n);
+}
+
+bool reserve_arena()
+{
+    int flags = MAP_PRIVATE | MAP_ANON;
+#ifdef MAP_NORESERVE
+    flags |= MAP_NORESERVE;
+#endif
+
+    void* p = mmap(nullptr, ARENA_SIZE, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+    if ( p == MAP_FAILED )
+        return false;
+
+    s_base = s_next = (uint8_t*)p;
+    s_end.store(s_base + ARENA_SIZE, std::memory_order_release);
+    return true;
+}
+
+// call with s_lock held
+Block* carve_slab(unsigned c)
+{
+    if ( !s_base )
+    {
+        if ( s_no_arena || !reserve_arena() )
+        {
+            s_no_arena = true;
+            return nullptr;
+        }
+    }
+
+    if ( s_next + SLAB_SIZE > s_base + ARENA_SIZE )
+        return nullptr;
+
+    uint8_t* slab = s_next;
+    s_next += SLAB_SIZE;
+    s_slab_class[(slab - s_base) >> SLAB_SHIFT] = c;
+
+    const size_t size = s_class_size[c];
+    Block* head = nullptr;
+
+    for ( size_t n = SLAB_SIZE / size; n > 0; --n )
+    {
+        Block* b = (Block*)(slab + (n - 1) * size);
+        b->next = head;
+        head = b;
+    }
+    return head;
+}
+
+// move up to max blocks from one list to another
+inline unsigned move(Block*& from, Block*& to, unsigned max)
+{
+    unsigned n = 0;
+
+    while ( from && n < max )
+    {
+        Block* b = from;
+        from = b->next;
+        b->next = to;
+        to = b;
+        ++n;
+    }
+    return n;
+}
+
+} // namespace
+
+// -----------------------------------------------------------------------------
+// thread cache
+// -----------------------------------------------------------------------------
+
+const unsigned MemoryCache::NUM_CLASSES;
+const size_t MemoryCache::MAX_SIZE;
+
+size_t MemoryCache::class_size(unsigned c)
+{
+    assert(c <= NUM_CLASSES);
+    return s_class_size[c];
+}
+
+unsigned MemoryCache::lookup(const void* p)
+{
+    const uint8_t* end = s_end.load(std::memory_order_acquire);
+    const uint8_t* q = (const uint8_t*)p;
+
+    // end is null until the arena is reserved
+    if ( q >= end )
+        return 0;
+
+    const uint8_t* base = end - ARENA_SIZE;
+
+    if ( q < base )
+        return 0;
+
+    return s_slab_class[(q - base) >> SLAB_SHIFT];
+}
+
+void* MemoryCache::pop(unsigned c)
+{
+    Bin& bin = s_bins[c];
+    Block* b = bin.head;
+
+    if ( !b )
+        return nullptr;
+
+    bin.head = b->next;
+    bin.count--;
+    memory_counts.cached_allocs++;
+    return b;
+}
+
+void MemoryCache::push(void* p, unsigned c)
+{
+    Bin& bin = s_bins[c];
+    Block* b = (Block*)p;
+
+    set_thread_exit();
+    b->next = bin.head;
+    bin.head = b;
+    bin.count++;
+}
+
+size_t MemoryCache::refill_size(unsigned c)
+{ return batch_count(c) * s_class_size[c]; }
+
+size_t MemoryCache::refill(unsigned c)
+{
+    assert(c && c <= NUM_CLASSES);
+    Bin& bin = s_bins[c];
+    unsigned n;
+
+    set_thread_exit();
+    {
+        std::lock_guard<std::mutex> hold(s_lock);
+
+        if ( !s_pool[c] )
+            s_pool[c] = carve_slab(c);
+
+        n = move(s_pool[c], bin.head, batch_count(c));
+    }
+    if ( !n )
+        return 0;
+
+    bin.count += n;
+    memory_counts.refills++;
+    return n * s_class_size[c];
+}
+
+size_t MemoryCache::trim(unsigned c)
+{
+    Bin& bin = s_bins[c];
+    const unsigned batch = batch_count(c);
+
+    if ( bin.count <= 2 * batch )
+        return 0;
+
+    {
+        std::lock_guard<std::mutex> hold(s_lock);
+        move(bin.head, s_pool[c], batch);
+    }
+    bin.count -= batch;
+    memory_counts.flushes++;
+    return batch * s_class_size[c];
+}
+
+size_t MemoryCache::flush()
+{
+    size_t bytes = 0;
+    std::lock_guard<std::mutex> hold(s_lock);
+
+    for ( unsigned c = 1; c <= NUM_CLASSES; ++c )
+    {
+        Bin& bin = s_bins[c];
+
+        if ( !bin.count )
+            continue;
+
+        bytes += bin.count * s_class_size[c];
+        move(bin.head, s_pool[c], bin.count);
+        bin.count = 0;
+        memory_counts.flushes++;
+    }
+    return bytes;
+}
+
+void MemoryCache::thread_term()
+{ MemoryCap::update_deallocations(flush()); }
+
+} // namespace memory
+
+#ifdef UNIT_TEST
+
+TEST_CASE( "memory cache size classes", "[memory]" )
+{
+    using memory::MemoryCache;
+
+    CHECK( MemoryCache::size_class(0) == 1 );
+    CHECK( MemoryCache::size_class(MemoryCache::MAX_SIZE) == MemoryCache::NUM_CLASSES );
+    CHECK( MemoryCache::size_class(MemoryCache::MAX_SIZE + 1) == 0 );
+
+    for ( size_t n = 1; n <= MemoryCache::MAX_SIZE; ++n )
+    {
+        unsigned c = MemoryCache::size_class(n);
+
+        // smallest class that fits
+        REQUIRE( MemoryCache::class_size(c) >= n );
+        REQUIRE( MemoryCache::class_size(c - 1) < n );
+    }
+}
+
+TEST_CASE( "memory cache refill and flush", "[memory]" )
+{
+    using memory::MemoryCache;
+
+    // other allocations in this thread go through the cache too so use
+    // a class they are unlikely to touch
+    const unsigned c = MemoryCache::NUM_CLASSES;
+    MemoryCache::flush();
+
+    int local;
+    CHECK( MemoryCache::lookup(&local) == 0 );
+    CHECK( MemoryCache::pop(c) == nullptr );
+
+    size_t n = MemoryCache::refill(c);
+
+    // the arena may not be available here
+    if ( n )
+    {
+        CHECK( n == MemoryCache::refill_size(c) );
+
+        void* p = MemoryCache::pop(c);
+        REQUIRE( p );
+        CHECK( MemoryCache::lookup(p) == c );
+
+        MemoryCache::push(p, c);
+        CHECK( MemoryCache::trim(c) == 0 );
+        CHECK( MemoryCache::flush() >= n );
+        CHECK( MemoryCache::pop(c) == nullptr );
+    }
+}
+
+TEST_CASE( "memory cache thread exit", "[memory]" )
+{
+    using memory::MemoryCache;
+
+    const unsigned c = MemoryCache::NUM_CLASSES;
+    MemoryCache::flush();
+
+    void* p = nullptr;
+
+    // the thread exits without calling thread_term()
+    std::thread t([&p]()
+    {
+        if ( MemoryCache::refill(c) )
+        {
+            p = MemoryCache::pop(c);
+            MemoryCache::push(p, c);
+        }
+    });
+    t.join();
+
+    if ( p )
+    {
+        // the thread's bin went back to the head of the shared pool
+        REQUIRE( MemoryCache::refill(c) );
+        bool found = false;
+
+        while ( void* q = MemoryCache::pop(c) )
+            found = found || q == p;
+
+        CHECK( found );
+    }
+    MemoryCache::flush();
+}
+
+#endif
@@ -0,0 +1,78 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// memory_cache.h
+
+#ifndef MEMORY_CACHE_H
+#define MEMORY_CACHE_H
+
+// per-thread size class cache for small allocations.  blocks are carved
+// from slabs in one reserved address range so the size class of a block
+// is found from its address and no header is needed.  cap accounting is
+// done in batches as blocks move between a thread and the shared pool.
+
+#include <cstddef>
+
+namespace memory
+{
+
+class MemoryCache
+{
+public:
+    static const unsigned NUM_CLASSES = 20;
+    static const size_t MAX_SIZE = 1024;
+
+    // size class for n bytes, or 0 if too large to cache
+    static unsigned size_class(size_t n);
+    static size_t class_size(unsigned);
+
+    // size class of p, or 0 if p did not come from the cache
+    static unsigned lookup(const void* p);
+
+    // take a block from this thread's cache; nullptr if empty
+    static void* pop(unsigned);
+    static void push(void*, unsigned);
+
+    // bytes a refill may move into this thread's cache
+    static size_t refill_size(unsigned);
+
+    // these return the number of bytes moved into or out of the thread
+    static size_t refill(unsigned);
+    static size_t trim(unsigned);
+    static size_t flush();
+
+    // return all cached blocks to the shared pool; also done automatically
+    // when any thread that used the cache exits
+    static void thread_term();
+};
+
+inline unsigned MemoryCache::size_class(size_t n)
+{
+    if ( n <= 128 )
+        return n ? (n + 15) >> 4 : 1;
+
+    if ( n > MAX_SIZE )
+        return 0;
+
+    // four classes per power of 2 above 128
+    unsigned shift = 63 - __builtin_clzll(n - 1);
+    return 9 + 4 * (shift - 7) + ((n - 1 - ((size_t)1 << shift)) >> (shift - 2));
+}
+
+} // namespace memory
+
+#endif
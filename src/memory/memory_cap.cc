@@ -67,6 +67,7 @@ struct Tracker
 };
 
 THREAD_LOCAL Tracker s_tracker;
+THREAD_LOCAL unsigned s_tier = MemoryCap::TIER_NONE;
 
 // -----------------------------------------------------------------------------
 // helpers
@@ -111,6 +112,29 @@ inline bool free_space(size_t requested, size_t cap, Tracker& trk, Handler& hand
 inline size_t calculate_threshold(size_t cap, size_t threshold)
 { return cap * threshold / 100; }
 
+// highest tier whose threshold has been reached
+inline unsigned select_tier(size_t used, const size_t* thresholds, unsigned max)
+{
+    for ( unsigned t = max - 1; t > 0; --t )
+    {
+        if ( thresholds[t] && used >= thresholds[t] )
+            return t;
+    }
+    return 0;
+}
+
+inline void count_tier(unsigned tier)
+{
+    switch ( tier )
+    {
+    case MemoryCap::TIER_FLUSH: memory_counts.flush_tier++; break;
+    case MemoryCap::TIER_DEPTH: memory_counts.depth_tier++; break;
+    case MemoryCap::TIER_BUFFER: memory_counts.buffer_tier++; break;
+    case MemoryCap::TIER_PRUNE: memory_counts.prune_tier++; break;
+    default: break;
+    }
+}
+
 } // namespace
 
 // -----------------------------------------------------------------------------
@@ -119,6 +143,8 @@ inline size_t calculate_threshold(size_t cap, size_t threshold)
 
 size_t MemoryCap::thread_cap = 0;
 size_t MemoryCap::preemptive_threshold = 0;
+size_t MemoryCap::tier_threshold[TIER_MAX] = { };
+int64_t MemoryCap::degraded_depth = 0;
 
 // -----------------------------------------------------------------------------
 // public interface
@@ -156,6 +182,34 @@ bool MemoryCap::over_threshold()
     return s_tracker.used() >= preemptive_threshold;
 }
 
+MemoryCap::Tier MemoryCap::update_tier()
+{
+    unsigned tier = select_tier(s_tracker.used(), tier_threshold, TIER_MAX);
+
+    // count each tier entered on the way up
+    for ( unsigned t = s_tier + 1; t <= tier; ++t )
+        count_tier(t);
+
+#ifdef DEBUG_MSGS
+    if ( tier != s_tier )
+        DebugFormat(DEBUG_MEMORY, "memory tier %u -> %u at %zu\n", s_tier, tier, s_tracker.used());
+#endif
+
+    s_tier = tier;
+    return (Tier)tier;
+}
+
+MemoryCap::Tier MemoryCap::get_tier()
+{ return (Tier)s_tier; }
+
+int64_t MemoryCap::limit_depth(int64_t depth)
+{
+    if ( s_tier < TIER_DEPTH || depth <= degraded_depth )
+        return depth;
+
+    return degraded_depth;
+}
+
 // FIXIT-L this should not be called while the packet threads are running.
 // once reload is implemented for the memory manager, the configuration
 // model will need to be updated
@@ -166,6 +220,9 @@ void MemoryCap::calculate(unsigned num_threads)
 
     assert(!is_packet_thread());
 
+    for ( auto& t : tier_threshold )
+        t = 0;
+
     if ( !config.cap )
     {
         thread_cap = preemptive_threshold = 0;
@@ -194,6 +251,12 @@ void MemoryCap::calculate(unsigned num_threads)
         DebugFormat(DEBUG_MEMORY,
             "per-thread pre-emptive action threshold set to %zu\n", preemptive_threshold);
     }
+
+    tier_threshold[TIER_FLUSH] = memory::calculate_threshold(thread_cap, config.flush_tier);
+    tier_threshold[TIER_DEPTH] = memory::calculate_threshold(thread_cap, config.depth_tier);
+    tier_threshold[TIER_BUFFER] = memory::calculate_threshold(thread_cap, config.buffer_tier);
+    tier_threshold[TIER_PRUNE] = preemptive_threshold;
+    degraded_depth = config.degraded_depth;
 }
 
 void MemoryCap::print()
@@ -206,7 +269,12 @@ void MemoryCap::print()
     LogMessage("    cap type: %s\n", config.soft? "soft" : "hard");
     LogMessage("    thread cap: %zu\n", thread_cap);
     LogMessage("    preemptive threshold: %zu\n", preemptive_threshold);
+    LogMessage("    flush tier: %zu\n", tier_threshold[TIER_FLUSH]);
+    LogMessage("    depth tier: %zu\n", tier_threshold[TIER_DEPTH]);
+    LogMessage("    buffer tier: %zu\n", tier_threshold[TIER_BUFFER]);
+    LogMessage("    degraded depth: %zu\n", (size_t)degraded_depth);
     LogMessage("    main thread usage: %zu\n", s_tracker.used());
+    LogMessage("    main thread tier: %u\n", s_tier);
     LogMessage("\n");
 }
 
@@ -295,4 +363,19 @@ TEST_CASE( "memory cap free space", "[memory]" )
     }
 }
 
+TEST_CASE( "memory cap select tier", "[memory]" )
+{
+    using memory::MemoryCap;
+    size_t thresholds[MemoryCap::TIER_MAX] = { 0, 50, 60, 0, 80 };
+
+    CHECK( memory::select_tier(10, thresholds, MemoryCap::TIER_MAX) == MemoryCap::TIER_NONE );
+    CHECK( memory::select_tier(50, thresholds, MemoryCap::TIER_MAX) == MemoryCap::TIER_FLUSH );
+    CHECK( memory::select_tier(70, thresholds, MemoryCap::TIER_MAX) == MemoryCap::TIER_DEPTH );
+    CHECK( memory::select_tier(90, thresholds, MemoryCap::TIER_MAX) == MemoryCap::TIER_PRUNE );
+
+    // disabled tiers are skipped
+    size_t none[MemoryCap::TIER_MAX] = { };
+    CHECK( memory::select_tier(90, none, MemoryCap::TIER_MAX) == MemoryCap::TIER_NONE );
+}
+
 #endif
@@ -22,6 +22,7 @@
 #define MEMORY_CAP_H
 
 #include <cstddef>
+#include <cstdint>
 
 namespace memory
 {
@@ -29,12 +30,25 @@ namespace memory
 class MemoryCap
 {
 public:
+    // as usage rises inspection is scaled back a tier at a time before
+    // flows are pruned; each tier includes the ones below it
+    enum Tier
+    { TIER_NONE, TIER_FLUSH, TIER_DEPTH, TIER_BUFFER, TIER_PRUNE, TIER_MAX };
+
     static bool free_space(size_t);
     static void update_allocations(size_t);
     static void update_deallocations(size_t);
 
     static bool over_threshold();
 
+    // call once per packet to set this thread's tier from its usage
+    static Tier update_tier();
+    static Tier get_tier();
+
+    // apply the degraded depth in the depth tier; negative depths
+    // are returned as is
+    static int64_t limit_depth(int64_t);
+
     // call from main thread
     static void calculate(unsigned num_threads);
 
@@ -44,6 +58,8 @@ public:
 private:
     static size_t thread_cap;
     static size_t preemptive_threshold;
+    static size_t tier_threshold[TIER_MAX];
+    static int64_t degraded_depth;
 };
 
 } // namespace memory
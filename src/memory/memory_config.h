@@ -29,6 +29,12 @@ struct MemoryConfig
     bool soft = false;
     size_t threshold = 0;
 
+    // degradation tiers (percent of cap, 0 to disable)
+    size_t flush_tier = 0;
+    size_t depth_tier = 0;
+    size_t buffer_tier = 0;
+    size_t degraded_depth = 16384;
+
     constexpr MemoryConfig() = default;
 };
 
@@ -29,7 +29,9 @@
 #include "main/thread.h"
 
 #include "memory_allocator.h"
+#include "memory_cache.h"
 #include "memory_cap.h"
+#include "memory_module.h"
 
 #ifdef UNIT_TEST
 #include "catch/catch.hpp"
@@ -132,7 +134,8 @@ private:
     bool& flag;
 };
 
-template<typename Allocator = MemoryAllocator, typename Cap = MemoryCap>
+template<typename Allocator = MemoryAllocator, typename Cap = MemoryCap,
+    typename Cache = MemoryCache>
 struct Interface
 {
     static void* allocate(size_t);
@@ -141,13 +144,46 @@ struct Interface
     static THREAD_LOCAL bool in_allocation_call;
 };
 
-template<typename Allocator, typename Cap>
-void* Interface<Allocator, Cap>::allocate(size_t n)
+template<typename Allocator, typename Cap, typename Cache>
+void* Interface<Allocator, Cap, Cache>::allocate(size_t n)
 {
     // prevent allocation reentry
     ReentryContext reentry_context(in_allocation_call);
     assert(!reentry_context.is_reentry());
 
+    if ( unsigned c = Cache::size_class(n) )
+    {
+        void* p = Cache::pop(c);
+
+        if ( !p )
+        {
+            // cached blocks count against the cap so give them back
+            // before refusing the request
+            const size_t want = Cache::refill_size(c);
+
+            if ( !Cap::free_space(want) )
+            {
+                Cap::update_deallocations(Cache::flush());
+
+                if ( !Cap::free_space(want) )
+                    return nullptr;
+            }
+
+            if ( const size_t got = Cache::refill(c) )
+            {
+                Cap::update_allocations(got);
+                p = Cache::pop(c);
+            }
+        }
+
+        if ( p )
+            return p;
+
+        // the cache is out of space so use the heap
+    }
+
+    memory_counts.heap_allocs++;
+
     if ( !Cap::free_space(Metadata::calculate_total_size(n)) )
         return nullptr;
 
@@ -159,12 +195,22 @@ void* Interface<Allocator, Cap>::allocate(size_t n)
     return meta->payload_offset();
 }
 
-template<typename Allocator, typename Cap>
-void Interface<Allocator, Cap>::deallocate(void* p)
+template<typename Allocator, typename Cap, typename Cache>
+void Interface<Allocator, Cap, Cache>::deallocate(void* p)
 {
     if ( !p )
         return;
 
+    if ( unsigned c = Cache::lookup(p) )
+    {
+        Cache::push(p, c);
+
+        if ( const size_t n = Cache::trim(c) )
+            Cap::update_deallocations(n);
+
+        return;
+    }
+
     auto meta = Metadata::extract(p);
     assert(meta);
 
@@ -172,8 +218,8 @@ void Interface<Allocator, Cap>::deallocate(void* p)
     Allocator::deallocate(meta);
 }
 
-template<typename Allocator, typename Cap>
-THREAD_LOCAL bool Interface<Allocator, Cap>::in_allocation_call = false;
+template<typename Allocator, typename Cap, typename Cache>
+THREAD_LOCAL bool Interface<Allocator, Cap, Cache>::in_allocation_call = false;
 
 } //namespace memory
 
@@ -307,6 +353,84 @@ size_t CapSpy::update_allocations_arg = 0;
 bool CapSpy::update_deallocations_called = false;
 size_t CapSpy::update_deallocations_arg = 0;
 
+// takes nothing so everything goes to the allocator
+struct NoCache
+{
+    static unsigned size_class(size_t)
+    { return 0; }
+
+    static unsigned lookup(const void*)
+    { return 0; }
+
+    static void* pop(unsigned) { return nullptr; }
+    static void push(void*, unsigned) { }
+    static size_t refill_size(unsigned) { return 0; }
+    static size_t refill(unsigned) { return 0; }
+    static size_t trim(unsigned) { return 0; }
+    static size_t flush() { return 0; }
+};
+
+struct CacheSpy
+{
+    static unsigned size_class(size_t)
+    { return 1; }
+
+    static unsigned lookup(const void* p)
+    { return p == pool ? 1 : 0; }
+
+    static void* pop(unsigned)
+    {
+        void* p = cached;
+        cached = nullptr;
+        return p;
+    }
+
+    static void push(void* p, unsigned)
+    { push_arg = p; }
+
+    static size_t refill_size(unsigned)
+    { return 64; }
+
+    static size_t refill(unsigned)
+    {
+        refill_called = true;
+
+        if ( refill_result )
+            cached = pool;
+
+        return refill_result;
+    }
+
+    static size_t trim(unsigned)
+    { return trim_result; }
+
+    static size_t flush()
+    { flush_called = true; return 0; }
+
+    static void reset()
+    {
+        pool = cached = push_arg = nullptr;
+        refill_result = trim_result = 0;
+        refill_called = flush_called = false;
+    }
+
+    static void* pool;
+    static void* cached;
+    static void* push_arg;
+    static size_t refill_result;
+    static size_t trim_result;
+    static bool refill_called;
+    static bool flush_called;
+};
+
+void* CacheSpy::pool = nullptr;
+void* CacheSpy::cached = nullptr;
+void* CacheSpy::push_arg = nullptr;
+size_t CacheSpy::refill_result = 0;
+size_t CacheSpy::trim_result = 0;
+bool CacheSpy::refill_called = false;
+bool CacheSpy::flush_called = false;
+
 } // namespace t_memory
 
 TEST_CASE( "memory metadata", "[memory]" )
@@ -352,7 +476,7 @@ TEST_CASE( "memory manager interface", "[memory]" )
     constexpr size_t n = 1;
     char pool[sizeof(memory::Metadata) + n];
 
-    using Interface = memory::Interface<AllocatorSpy, CapSpy>;
+    using Interface = memory::Interface<AllocatorSpy, CapSpy, NoCache>;
 
     SECTION( "allocation" )
     {
@@ -433,4 +557,73 @@ TEST_CASE( "memory manager interface", "[memory]" )
     }
 }
 
+TEST_CASE( "memory manager cache", "[memory]" )
+{
+    using namespace t_memory;
+
+    AllocatorSpy::reset();
+    CapSpy::reset();
+    CacheSpy::reset();
+
+    char pool[64];
+    CacheSpy::pool = pool;
+
+    using Interface = memory::Interface<AllocatorSpy, CapSpy, CacheSpy>;
+
+    SECTION( "hit" )
+    {
+        CacheSpy::cached = pool;
+
+        CHECK( Interface::allocate(1) == (void*)pool );
+
+        CHECK_FALSE( CacheSpy::refill_called );
+        CHECK_FALSE( CapSpy::free_space_called );
+        CHECK_FALSE( CapSpy::update_allocations_called );
+    }
+
+    SECTION( "refill" )
+    {
+        CapSpy::free_space_result = true;
+        CacheSpy::refill_result = 64;
+
+        CHECK( Interface::allocate(1) == (void*)pool );
+
+        CHECK( CapSpy::free_space_arg == 64 );
+        CHECK( CapSpy::update_allocations_arg == 64 );
+        CHECK_FALSE( AllocatorSpy::allocate_called );
+    }
+
+    SECTION( "refill over cap" )
+    {
+        CacheSpy::refill_result = 64;
+
+        CHECK( Interface::allocate(1) == nullptr );
+
+        CHECK( CacheSpy::flush_called );
+        CHECK_FALSE( CacheSpy::refill_called );
+        CHECK_FALSE( AllocatorSpy::allocate_called );
+    }
+
+    SECTION( "out of space" )
+    {
+        CapSpy::free_space_result = true;
+
+        Interface::allocate(1);
+
+        CHECK( CacheSpy::refill_called );
+        CHECK( AllocatorSpy::allocate_called );
+    }
+
+    SECTION( "deallocation" )
+    {
+        CacheSpy::trim_result = 64;
+
+        Interface::deallocate(pool);
+
+        CHECK( CacheSpy::push_arg == (void*)pool );
+        CHECK( CapSpy::update_deallocations_arg == 64 );
+        CHECK_FALSE( AllocatorSpy::deallocate_called );
+    }
+}
+
 #endif
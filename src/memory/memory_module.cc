@@ -43,9 +43,39 @@ static const Parameter s_params[] =
         "set the per-packet-thread threshold for preemptive cleanup actions "
         "(percent, 0 to disable)" },
 
+    { "flush_tier", Parameter::PT_INT, "0:100", "0",
+        "shrink stream flush points above this usage "
+        "(percent, 0 to disable)" },
+
+    { "depth_tier", Parameter::PT_INT, "0:100", "0",
+        "limit file and http inspection depth above this usage "
+        "(percent, 0 to disable)" },
+
+    { "buffer_tier", Parameter::PT_INT, "0:100", "0",
+        "stop tcp reassembly for flows without a service inspector above this usage "
+        "(percent, 0 to disable)" },
+
+    { "degraded_depth", Parameter::PT_INT, "0:", "16384",
+        "inspection depth limit in the depth tier (bytes)" },
+
     { nullptr, Parameter::PT_MAX, nullptr, nullptr, nullptr }
 };
 
+static const PegInfo s_pegs[] =
+{
+    { "cached allocs", "allocations served from the thread cache" },
+    { "heap allocs", "allocations too large for the thread cache" },
+    { "cache refills", "batches moved from the shared pool to the thread cache" },
+    { "cache flushes", "batches returned from the thread cache to the shared pool" },
+    { "flush tier", "number of times flush points were shrunk" },
+    { "depth tier", "number of times inspection depths were limited" },
+    { "buffer tier", "number of times reassembly was stopped for unserviced flows" },
+    { "prune tier", "number of times flows were pruned preemptively" },
+    { nullptr, nullptr }
+};
+
+THREAD_LOCAL MemoryCounts memory_counts;
+
 // -----------------------------------------------------------------------------
 // memory module
 // -----------------------------------------------------------------------------
@@ -65,8 +95,26 @@ bool MemoryModule::set(const char*, Value& v, SnortConfig* sc)
     else if ( v.is("threshold") )
         sc->memory->threshold = v.get_long();
 
+    else if ( v.is("flush_tier") )
+        sc->memory->flush_tier = v.get_long();
+
+    else if ( v.is("depth_tier") )
+        sc->memory->depth_tier = v.get_long();
+
+    else if ( v.is("buffer_tier") )
+        sc->memory->buffer_tier = v.get_long();
+
+    else if ( v.is("degraded_depth") )
+        sc->memory->degraded_depth = v.get_long();
+
     else
         return false;
 
     return true;
 }
+
+const PegInfo* MemoryModule::get_pegs() const
+{ return s_pegs; }
+
+PegCount* MemoryModule::get_counts() const
+{ return (PegCount*)&memory_counts; }
@@ -22,6 +22,21 @@
 #define MEMORY_MODULE_H
 
 #include "framework/module.h"
+#include "main/thread.h"
+
+struct MemoryCounts
+{
+    PegCount cached_allocs;
+    PegCount heap_allocs;
+    PegCount refills;
+    PegCount flushes;
+    PegCount flush_tier;
+    PegCount depth_tier;
+    PegCount buffer_tier;
+    PegCount prune_tier;
+};
+
+extern THREAD_LOCAL MemoryCounts memory_counts;
 
 class MemoryModule : public Module
 {
@@ -29,6 +44,9 @@ public:
     MemoryModule();
 
     bool set(const char*, Value&, SnortConfig*) override;
+
+    const PegInfo* get_pegs() const override;
+    PegCount* get_counts() const override;
 };
 
 #endif
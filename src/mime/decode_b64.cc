@@ -26,6 +26,10 @@
 #include "decode_base.h"
 #include "decode_buffer.h"
 
+#ifdef UNIT_TEST
+#include "catch/catch.hpp"
+#endif
+
 void B64Decode::reset_decode_state()
 {
     reset_decoded_bytes();
@@ -151,6 +155,31 @@ int sf_base64decode(uint8_t* inbuf, uint32_t inbuf_size, uint8_t* outbuf, uint32
     outbuf_ptr = outbuf;
     while ((cursor < endofinbuf) && (n < max_base64_chars))
     {
+        /* Fast path: a whole group of four valid characters without padding
+         * is decoded at once.  Anything else (line breaks, junk, '=', a group
+         * split by skipped characters, a nearly full outbuf) goes through the
+         * character at a time code below. */
+        if ((base64data_ptr == base64data) && (endofinbuf - cursor >= 4) &&
+            (n + 4 <= max_base64_chars) && (*bytes_written + 3 <= outbuf_size))
+        {
+            tableval_a = sf_decode64tab[cursor[0]];
+            tableval_b = sf_decode64tab[cursor[1]];
+            tableval_c = sf_decode64tab[cursor[2]];
+            tableval_d = sf_decode64tab[cursor[3]];
+
+            /* valid values are < 64, '=' is 99 and junk is 100 */
+            if (!((tableval_a | tableval_b | tableval_c | tableval_d) & 0xC0))
+            {
+                *outbuf_ptr++ = (tableval_a << 2) | (tableval_b >> 4);
+                *outbuf_ptr++ = (tableval_b << 4) | (tableval_c >> 2);
+                *outbuf_ptr++ = (tableval_c << 6) | tableval_d;
+                *bytes_written += 3;
+                n += 4;
+                cursor += 4;
+                continue;
+            }
+        }
+
         if (sf_decode64tab[*cursor] != 100)
         {
             *base64data_ptr++ = *cursor;
@@ -211,3 +240,38 @@ int sf_base64decode(uint8_t* inbuf, uint32_t inbuf_size, uint8_t* outbuf, uint32
         return(0);
 }
 
+//--------------------------------------------------------------------------
+// unit tests
+//--------------------------------------------------------------------------
+
+#ifdef UNIT_TEST
+static std::string b64(const char* in, uint32_t max = 64)
+{
+    uint8_t out[64];
+    uint32_t n = 0;
+
+    if ( sf_base64decode((uint8_t*)in, strlen(in), out, max, &n) )
+        return "error";
+
+    return std::string((char*)out, n);
+}
+
+TEST_CASE("base64 groups", "[base64]")
+{
+    CHECK(b64("U25vcnQrKw==") == "Snort++");
+    CHECK(b64("U25vcnQrKys=") == "Snort+++");
+    CHECK(b64("U25vcnQrKysr") == "Snort++++");
+}
+
+TEST_CASE("base64 skips junk", "[base64]")
+{
+    CHECK(b64("U25v\r\ncnQr\nKw==") == "Snort++");
+    CHECK(b64("U2 5vc*nQrKw==") == "Snort++");
+}
+
+TEST_CASE("base64 limits", "[base64]")
+{
+    CHECK(b64("U25vcnQrKw==", 4) == "Snor");
+    CHECK(b64("=25vcnQrKw==") == "error");
+}
+#endif
@@ -91,6 +91,20 @@ QPDecode::~QPDecode()
         delete buffer;
 }
 
+static inline int hex_value(char ch)
+{
+    if ((ch >= '0') && (ch <= '9'))
+        return ch - '0';
+
+    if ((ch >= 'a') && (ch <= 'f'))
+        return ch - 'a' + 10;
+
+    if ((ch >= 'A') && (ch <= 'F'))
+        return ch - 'A' + 10;
+
+    return -1;
+}
+
 int sf_qpdecode(char* src, uint32_t slen, char* dst, uint32_t dlen, uint32_t* bytes_read,
     uint32_t* bytes_copied)
 {
@@ -124,18 +138,11 @@ int sf_qpdecode(char* src, uint32_t slen, char* dst, uint32_t dlen, uint32_t* by
                         *bytes_read += 2;
                         continue;
                     }
-                    if (isxdigit((int)ch1) && isxdigit((int)ch2))
+                    int hi = hex_value(ch1);
+                    int lo = hex_value(ch2);
+                    if ((hi >= 0) && (lo >= 0))
                     {
-                        char hexBuf[3];
-                        char* eptr;
-                        hexBuf[0] = ch1;
-                        hexBuf[1] = ch2;
-                        hexBuf[2] = '\0';
-                        dst[*bytes_copied]= (char)strtoul(hexBuf, &eptr, 16);
-                        if ((*eptr != '\0'))
-                        {
-                            return -1;
-                        }
+                        dst[*bytes_copied]= (char)((hi << 4) | lo);
                         *bytes_read += 2;
                         *bytes_copied +=1;
                         continue;
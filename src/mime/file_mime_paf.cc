@@ -26,9 +26,13 @@
 #include "config.h"
 #endif
 
+#include <ctype.h>
+#include <string.h>
+
 #include "main/snort_types.h"
 #include "main/snort_debug.h"
 #include "file_api/file_api.h"
+#include "utils/util_delim.h"
 
 #include "file_mime_config.h"
 
@@ -224,3 +228,61 @@ bool check_data_end(void* data_end_state,  uint8_t val)
     return false;
 }
 
+uint32_t skip_mime_paf_data(const MimeDataPafInfo* data_info, const uint8_t* data, uint32_t len)
+{
+    switch (data_info->data_state)
+    {
+    case MIME_PAF_FINDING_BOUNDARY_STATE:
+        /* Only '.' or white space can start a boundary= search */
+        if (!data_info->boundary_search)
+        {
+            uint32_t i = 0;
+
+            while ((i < len) && (data[i] != '.') && !isspace(data[i]))
+                i++;
+
+            return i;
+        }
+        break;
+
+    case MIME_PAF_FOUND_BOUNDARY_STATE:
+        /* Only '-' can start a boundary signature */
+        if (data_info->boundary_state == MIME_PAF_BOUNDARY_UNKNOWN)
+        {
+            const uint8_t* p = (const uint8_t*)memchr(data, '-', len);
+            return p ? (uint32_t)(p - data) : len;
+        }
+        break;
+
+    default:
+        break;
+    }
+
+    return 0;
+}
+
+uint32_t skip_data_end(const void* data_end_state, const uint8_t* data, uint32_t len)
+{
+    if (*((const DataEndState*)data_end_state) != PAF_DATA_END_UNKNOWN)
+        return 0;
+
+    return find_eol(data, len);
+}
+
+uint32_t skip_mime_paf_data(
+    const MimeDataPafInfo* data_info, const void* data_end_state, const uint8_t* data, uint32_t len)
+{
+    if (*((const DataEndState*)data_end_state) != PAF_DATA_END_UNKNOWN)
+        return 0;
+
+    /* '\n' is white space so the boundary= search stops there too */
+    if (data_info->data_state == MIME_PAF_FINDING_BOUNDARY_STATE)
+        return skip_mime_paf_data(data_info, data, len);
+
+    if ((data_info->data_state == MIME_PAF_FOUND_BOUNDARY_STATE) &&
+        (data_info->boundary_state == MIME_PAF_BOUNDARY_UNKNOWN))
+        return find_either(data, len, '\n', '-');
+
+    return 0;
+}
+
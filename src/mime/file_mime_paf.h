@@ -84,5 +84,13 @@ SO_PUBLIC void reset_mime_paf_state(MimeDataPafInfo*);
 SO_PUBLIC bool process_mime_paf_data(MimeDataPafInfo*,  uint8_t val);
 SO_PUBLIC bool check_data_end(void* end_state,  uint8_t val);
 
+/* Number of leading bytes that can't change the boundary search, the end
+ * of data search, or both; callers may pass over these instead of feeding
+ * them to process_mime_paf_data() and check_data_end() one at a time */
+SO_PUBLIC uint32_t skip_mime_paf_data(const MimeDataPafInfo*, const uint8_t* data, uint32_t len);
+SO_PUBLIC uint32_t skip_data_end(const void* end_state, const uint8_t* data, uint32_t len);
+SO_PUBLIC uint32_t skip_mime_paf_data(
+    const MimeDataPafInfo*, const void* end_state, const uint8_t* data, uint32_t len);
+
 #endif
 
@@ -25,6 +25,8 @@
 #include "time/clock_defs.h"
 #include "time/stopwatch.h"
 
+#include "time_sampler.h"
+
 struct TimeProfilerConfig
 {
     enum Sort
@@ -38,6 +40,7 @@ struct TimeProfilerConfig
     bool show = false;
     unsigned count = 0;
     int max_depth = -1;
+    unsigned sample = 0;  // usecs per sample, 0 = time every check
 };
 
 struct SO_PUBLIC TimeProfilerStats
@@ -88,7 +91,12 @@ public:
     TimeContext(TimeProfilerStats& stats) :
         stats(stats)
     {
-        if ( stats.enter() )
+        if ( !stats.enter() )
+            return;
+
+        if ( TimeSampler::enabled() )
+            TimeSampler::push(&stats);
+        else
             sw.start();
     }
 
@@ -104,7 +112,16 @@ public:
         stopped_once = true;
 
         // don't bother updating time if context is reentrant
-        if ( stats.exit() )
+        if ( !stats.exit() )
+            return;
+
+        if ( TimeSampler::enabled() )
+        {
+            // elapsed is charged from the samples
+            TimeSampler::pop(&stats);
+            ++stats.checks;
+        }
+        else
             stats.update(sw.get());
     }
 
@@ -0,0 +1,249 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// time_sampler.cc
+
+#include "time_sampler.h"
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include <chrono>
+
+#include "log/messages.h"
+#include "utils/util.h"
+
+#include "time_profiler_defs.h"
+
+#ifdef UNIT_TEST
+#include "catch/catch.hpp"
+#endif
+
+THREAD_LOCAL TimeSampleStack time_sample_stack;
+
+bool TimeSampler::sampling = false;
+
+static hr_duration s_period;
+
+// ITIMER_PROF counts cpu time of the whole process and the signal is
+// delivered to the thread that is running when it expires, so samples
+// land on each packet thread in proportion to the cpu it uses.
+static void sample(int)
+{
+    auto& s = time_sample_stack;
+    unsigned n = s.depth;
+
+    std::atomic_signal_fence(std::memory_order_acquire);
+
+    for ( unsigned i = 0; i < n; ++i )
+        s.samples[i] = s.samples[i] + 1;
+}
+
+// contexts are scoped so ps is almost always on top.  the frame and any
+// above it are hidden from the handler before they are read or moved; a
+// sample that lands on the frames above meanwhile is dropped.
+void TimeSampler::pop(TimeProfilerStats* ps)
+{
+    auto& s = time_sample_stack;
+    unsigned top = s.depth;
+    unsigned n = top;
+
+    while ( n && s.stats[n - 1] != ps )
+        --n;
+
+    if ( !n )
+        return;
+
+    s.depth = n - 1;
+    std::atomic_signal_fence(std::memory_order_acq_rel);
+
+    sig_atomic_t taken = s.samples[n - 1];
+    ps->elapsed += taken * s_period;
+
+    for ( unsigned i = n; i < top; ++i )
+    {
+        s.stats[i - 1] = s.stats[i];
+        s.samples[i - 1] = s.samples[i];
+    }
+
+    std::atomic_signal_fence(std::memory_order_release);
+    s.depth = top - 1;
+}
+
+void TimeSampler::start(unsigned usecs)
+{
+    if ( !usecs )
+        return;
+
+    s_period = std::chrono::duration_cast<hr_duration>(
+        std::chrono::microseconds(clock_ticks(usecs)));
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    action.sa_handler = sample;
+
+    if ( sigaction(SIGPROF, &action, nullptr) )
+    {
+        ErrorMessage("can't install profiler sample handler: %s\n", get_error(errno));
+        return;
+    }
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = usecs / 1000000;
+    timer.it_interval.tv_usec = usecs % 1000000;
+    timer.it_value = timer.it_interval;
+
+    if ( setitimer(ITIMER_PROF, &timer, nullptr) )
+    {
+        ErrorMessage("can't start profiler sample timer: %s\n", get_error(errno));
+        signal(SIGPROF, SIG_DFL);
+        return;
+    }
+
+    sampling = true;
+}
+
+// call after packet threads are joined; a context that is still open
+// just adds no time when it stops
+void TimeSampler::stop()
+{
+    if ( !sampling )
+        return;
+
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, nullptr);
+
+    signal(SIGPROF, SIG_IGN);
+    sampling = false;
+}
+
+#ifdef UNIT_TEST
+
+TEST_CASE( "time sampler stack", "[profiler][time_sampler]" )
+{
+    TimeProfilerStats a, b, c;
+    auto& s = time_sample_stack;
+
+    REQUIRE( s.depth == 0 );
+
+    TimeSampler::push(&a);
+    TimeSampler::push(&b);
+    TimeSampler::push(&c);
+    CHECK( s.depth == 3 );
+
+    SECTION( "lifo" )
+    {
+        TimeSampler::pop(&c);
+        TimeSampler::pop(&b);
+        CHECK( s.depth == 1 );
+        CHECK( s.stats[0] == &a );
+        TimeSampler::pop(&a);
+    }
+
+    SECTION( "out of order" )
+    {
+        TimeSampler::pop(&b);
+        CHECK( s.depth == 2 );
+        CHECK( s.stats[0] == &a );
+        CHECK( s.stats[1] == &c );
+        TimeSampler::pop(&c);
+        TimeSampler::pop(&a);
+    }
+
+    SECTION( "charge" )
+    {
+        s_period = hr_duration(1000);
+        s.samples[0] = 1;
+        s.samples[1] = 2;
+        s.samples[2] = 3;
+
+        TimeSampler::pop(&b);
+        CHECK( b.elapsed == 2 * s_period );
+        CHECK( s.samples[1] == 3 );
+
+        TimeSampler::pop(&c);
+        TimeSampler::pop(&a);
+        CHECK( c.elapsed == 3 * s_period );
+        CHECK( a.elapsed == s_period );
+    }
+
+    SECTION( "not pushed" )
+    {
+        TimeProfilerStats d;
+        TimeSampler::pop(&d);
+        CHECK( s.depth == 3 );
+        TimeSampler::pop(&c);
+        TimeSampler::pop(&b);
+        TimeSampler::pop(&a);
+    }
+
+    CHECK( s.depth == 0 );
+}
+
+TEST_CASE( "time sampler context", "[profiler][time_sampler]" )
+{
+    TimeProfilerStats stats;
+
+    // the timer won't fire during the test with a 1 second period; the
+    // handler is called directly instead
+    TimeSampler::start(1000000);
+    REQUIRE( TimeSampler::enabled() );
+
+    {
+        TimeContext ctx(stats);
+        CHECK( time_sample_stack.depth == 1 );
+
+        for ( int i = 0; i < 3; ++i )
+            sample(SIGPROF);
+
+        CHECK( time_sample_stack.samples[0] >= 3 );
+    }
+    TimeSampler::stop();
+
+    CHECK( !TimeSampler::enabled() );
+    CHECK( time_sample_stack.depth == 0 );
+    CHECK( stats.checks == 1 );
+    CHECK( stats.elapsed >= 3 * s_period );
+}
+
+TEST_CASE( "time sampler overflow", "[profiler][time_sampler]" )
+{
+    TimeProfilerStats st[TIME_SAMPLER_DEPTH + 1];
+    auto& s = time_sample_stack;
+
+    for ( auto& ps : st )
+        TimeSampler::push(&ps);
+
+    CHECK( s.depth == TIME_SAMPLER_DEPTH );
+
+    for ( int i = TIME_SAMPLER_DEPTH; i >= 0; --i )
+        TimeSampler::pop(st + i);
+
+    CHECK( s.depth == 0 );
+}
+
+#endif
+
@@ -0,0 +1,86 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// time_sampler.h
+
+#ifndef TIME_SAMPLER_H
+#define TIME_SAMPLER_H
+
+// TimeSampler -- sampling mode for the module time profiler.  Instead of
+// reading the clock at the start and end of every check, a TimeContext just
+// pushes its stats on a per thread stack.  A SIGPROF interval timer then
+// counts a sample for every frame on the stack of the thread it interrupts
+// and each frame's samples are charged to its stats, one period of cpu time
+// apiece, when it is popped.  time is thus inclusive as with the Stopwatch
+// and the same report is produced.  the handler only writes the sample
+// counts of frames that are on the stack so it never races the thread's own
+// updates of elapsed.
+
+#include <csignal>
+
+#include <atomic>
+
+#include "main/snort_types.h"
+#include "main/thread.h"
+
+struct TimeProfilerStats;
+
+#define TIME_SAMPLER_DEPTH 32
+
+struct TimeSampleStack
+{
+    TimeProfilerStats* stats[TIME_SAMPLER_DEPTH];
+    volatile sig_atomic_t samples[TIME_SAMPLER_DEPTH];
+    volatile unsigned depth;
+};
+
+SO_PUBLIC extern THREAD_LOCAL TimeSampleStack time_sample_stack;
+
+class SO_PUBLIC TimeSampler
+{
+public:
+    // call from main thread; usecs of cpu time per sample
+    static void start(unsigned usecs);
+    static void stop();
+
+    static bool enabled()
+    { return sampling; }
+
+    // the signal handler may run between any two instructions so the
+    // entry must be in place before it is counted
+    static void push(TimeProfilerStats* ps)
+    {
+        auto& s = time_sample_stack;
+
+        if ( s.depth >= TIME_SAMPLER_DEPTH )
+            return;
+
+        s.stats[s.depth] = ps;
+        s.samples[s.depth] = 0;
+        std::atomic_signal_fence(std::memory_order_release);
+        s.depth = s.depth + 1;
+    }
+
+    // charges the samples taken while ps was on the stack
+    static void pop(TimeProfilerStats* ps);
+
+private:
+    static bool sampling;
+};
+
+#endif
+
@@ -76,6 +76,18 @@ public:
         return bnfaCompile(sc, obj);
     }
 
+    bool can_compile_parallel() override
+    { return true; }
+
+    int compile() override
+    { return bnfaCompileStates(obj); }
+
+    int finish(SnortConfig* sc) override
+    {
+        bnfaFinishCompile(sc, obj);
+        return 0;
+    }
+
     int _search(
         const uint8_t* T, int n, MpseMatch match,
         void* context, int* current_state) override
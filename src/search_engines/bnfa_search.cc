@@ -1461,9 +1461,20 @@ static inline int _bnfaCompile(bnfa_struct_t* bnfa)
 
     bnfa->bnfaMatchStates = cntMatchStates;
 
+    return 0;
+}
+
+int bnfaCompileStates(bnfa_struct_t* bnfa)
+{
+    return _bnfaCompile(bnfa);
+}
+
+void bnfaFinishCompile(SnortConfig* sc, bnfa_struct_t* bnfa)
+{
     bnfaAccumInfo(bnfa);
 
-    return 0;
+    if ( bnfa->agent )
+        bnfaBuildMatchStateTrees(sc, bnfa);
 }
 
 int bnfaCompile(
@@ -1472,9 +1483,7 @@ int bnfaCompile(
     if ( int rval = _bnfaCompile (bnfa) )
         return rval;
 
-    if ( bnfa->agent )
-        bnfaBuildMatchStateTrees(sc, bnfa);
-
+    bnfaFinishCompile(sc, bnfa);
     return 0;
 }
 
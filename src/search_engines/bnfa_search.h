@@ -168,6 +168,11 @@ int bnfaAddPattern(
 
 int bnfaCompile(struct SnortConfig*, bnfa_struct_t*);
 
+// bnfaCompile() in two steps; states may be compiled concurrently for
+// different instances, finish must be called from one thread
+int bnfaCompileStates(bnfa_struct_t*);
+void bnfaFinishCompile(struct SnortConfig*, bnfa_struct_t*);
+
 unsigned _bnfa_search_csparse_nfa(
     bnfa_struct_t * pstruct, const uint8_t* t, int tlen, MpseMatch,
     void* context, unsigned sindex, int* current_state);
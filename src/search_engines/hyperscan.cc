@@ -133,6 +133,12 @@ public:
 
     int prep_patterns(SnortConfig*) override;
 
+    bool can_compile_parallel() override
+    { return true; }
+
+    int compile() override;
+    int finish(SnortConfig*) override;
+
     int _search(const uint8_t*, int, MpseMatch, void*, int*) override;
 
     int get_pattern_count() override
@@ -152,6 +158,7 @@ private:
     PatternVector pvector;
 
     hs_database_t* hs_db = nullptr;
+    std::string compile_error;
 
     static THREAD_LOCAL MpseMatch match_cb;
     static THREAD_LOCAL void* match_ctx;
@@ -204,6 +211,16 @@ void HyperscanMpse::user_dtor()
 }
 
 int HyperscanMpse::prep_patterns(SnortConfig* sc)
+{
+    if ( int rval = compile() )
+        return rval;
+
+    return finish(sc);
+}
+
+// hs_compile_multi() is thread safe and only touches this instance.  this
+// may run on a worker thread so errors are saved and reported by finish().
+int HyperscanMpse::compile()
 {
     hs_compile_error_t* errptr = nullptr;
     std::vector<const char*> pats;
@@ -222,9 +239,17 @@ int HyperscanMpse::prep_patterns(SnortConfig* sc)
     if ( hs_compile_multi(&pats[0], &flags[0], &ids[0], pvector.size(), HS_MODE_BLOCK,
             nullptr, &hs_db, &errptr) or !hs_db )
     {
-        // FIXIT-L emit data from errptr
-        ParseError("can't compile pattern database '%s'", "hs_compile_multi");
+        compile_error = (errptr and errptr->message) ? errptr->message : "hs_compile_multi";
         hs_free_compile_error(errptr);
+    }
+    return 0;
+}
+
+int HyperscanMpse::finish(SnortConfig* sc)
+{
+    if ( !hs_db )
+    {
+        ParseError("can't compile pattern database '%s'", compile_error.c_str());
         return -1;
     }
 
@@ -22,9 +22,11 @@
 #include <sys/types.h>
 
 #include "utils/util.h"
+#include "decompress/inflate_pool.h"
 #include "detection/detection_util.h"
 #include "file_api/file_service.h"
 #include "file_api/file_flows.h"
+#include "memory/memory_cap.h"
 
 #include "http_module.h"
 #include "http_api.h"
@@ -190,7 +192,8 @@ void HttpMsgHeader::prepare_body()
     session_data->body_octets[source_id] = 0;
     const int64_t& depth = (source_id == SRC_CLIENT) ? params->request_depth :
         params->response_depth;
-    session_data->detect_depth_remaining[source_id] = (depth != -1) ? depth : INT64_MAX;
+    session_data->detect_depth_remaining[source_id] =
+        memory::MemoryCap::limit_depth((depth != -1) ? depth : INT64_MAX);
     if (session_data->detect_depth_remaining[source_id] > 0)
     {
         // Depth must be positive because first body section must actually go to detection in order
@@ -215,8 +218,8 @@ void HttpMsgHeader::setup_file_processing()
     // fully supports it remove the outer if statement that prevents it from being done.
     if (session_data->file_depth_remaining[1-source_id] <= 0)
     {
-        if ((session_data->file_depth_remaining[source_id] = FileService::get_max_file_depth())
-             < 0)
+        if ((session_data->file_depth_remaining[source_id] =
+            memory::MemoryCap::limit_depth(FileService::get_max_file_depth())) < 0)
         {
            session_data->file_depth_remaining[source_id] = 0;
            return;
@@ -351,18 +354,10 @@ void HttpMsgHeader::setup_decompression()
     if (compression == CMP_NONE)
         return;
 
-    session_data->compress_stream[source_id] = new z_stream;
-    session_data->compress_stream[source_id]->zalloc = Z_NULL;
-    session_data->compress_stream[source_id]->zfree = Z_NULL;
-    session_data->compress_stream[source_id]->next_in = Z_NULL;
-    session_data->compress_stream[source_id]->avail_in = 0;
     const int window_bits = (compression == CMP_GZIP) ? GZIP_WINDOW_BITS : DEFLATE_WINDOW_BITS;
-    if (inflateInit2(session_data->compress_stream[source_id], window_bits) != Z_OK)
-    {
+    session_data->compress_stream[source_id] = InflatePool::acquire(window_bits);
+    if (session_data->compress_stream[source_id] == nullptr)
         session_data->compression[source_id] = CMP_NONE;
-        delete session_data->compress_stream[source_id];
-        session_data->compress_stream[source_id] = nullptr;
-    }
 }
 
 void HttpMsgHeader::setup_utf_decoding()
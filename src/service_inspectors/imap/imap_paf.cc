@@ -182,6 +182,23 @@ static bool check_imap_data_end(ImapDataEnd* data_end_state,  uint8_t val)
     return false;
 }
 
+/*
+ * Number of leading literal bytes that can't complete the literal or reach
+ * a MIME boundary; these are passed over rather than processed one at a time.
+ */
+static inline uint32_t skip_literal(ImapPafData* pfdata, const uint8_t* data, uint32_t len)
+{
+    if (pfdata->imap_data_info.length <= 1)
+        return 0;
+
+    if (len > pfdata->imap_data_info.length - 1)
+        len = pfdata->imap_data_info.length - 1;
+
+    uint32_t n = skip_mime_paf_data(&(pfdata->mime_info), data, len);
+    pfdata->imap_data_info.length -= n;
+    return n;
+}
+
 /*
  * Statefully search for the data termination sequence or a MIME boundary.
  *
@@ -401,7 +418,10 @@ static StreamSplitter::Status imap_paf_server(ImapPafData* pfdata,
             break;
 
         case IMAP_PAF_DATA_STATE:
-            if (find_data_end_mime_data(ch, pfdata))
+            if (uint32_t n = skip_literal(pfdata, data + i, len - i))
+                i += n - 1;
+
+            else if (find_data_end_mime_data(ch, pfdata))
             {
                 // if not a boundary, wait for end of
                 // the server's response before flushing
@@ -267,7 +267,10 @@ static StreamSplitter::Status pop_paf_server(PopPafData* pfdata,
         switch (pfdata->pop_state)
         {
         case POP_PAF_MULTI_LINE_STATE:
-            if ( find_data_end_multi_line(pfdata, ch, false) )
+            if ( uint32_t n = skip_data_end(&(pfdata->end_state), data + i, len - i) )
+                i += n - 1;
+
+            else if ( find_data_end_multi_line(pfdata, ch, false) )
             {
                 *fp = i + 1;
                 return StreamSplitter::FLUSH;
@@ -276,7 +279,11 @@ static StreamSplitter::Status pop_paf_server(PopPafData* pfdata,
 
         case POP_PAF_DATA_STATE:
             // FIXIT-M statefully get length
-            if ( find_data_end_multi_line(pfdata, ch, true) )
+            if ( uint32_t n = skip_mime_paf_data(
+                &(pfdata->data_info), &(pfdata->end_state), data + i, len - i) )
+                i += n - 1;
+
+            else if ( find_data_end_multi_line(pfdata, ch, true) )
             {
                 *fp = i + 1;
                 return StreamSplitter::FLUSH;
@@ -275,6 +275,28 @@ static inline bool process_data(SmtpPafData* pfdata,  uint8_t data)
     return process_mime_paf_data(&(pfdata->data_info), data);
 }
 
+/* Number of leading data bytes that can't reach the data length, end of
+ * data, or a boundary; these are passed over rather than processed one at
+ * a time */
+static inline uint32_t skip_data(SmtpPafData* pfdata, const uint8_t* data, uint32_t len)
+{
+    if (pfdata->length)
+    {
+        if (pfdata->length == 1)
+            return 0;
+
+        if (len > pfdata->length - 1)
+            len = pfdata->length - 1;
+    }
+
+    uint32_t n = skip_mime_paf_data(&(pfdata->data_info), &(pfdata->data_end_state), data, len);
+
+    if (pfdata->length)
+        pfdata->length -= n;
+
+    return n;
+}
+
 /* Process commands/data from client
  *  * For command, flush at EOL
  *   * For data, flush at boundary
@@ -319,6 +341,9 @@ static inline StreamSplitter::Status smtp_paf_client(SmtpPafData* pfdata,
                 if ( (i == len-1) && (pfdata->smtp_state != SMTP_PAF_CMD_STATE) )
                     pfdata->data_info.boundary_len += len;
             }
+            else if (uint32_t n = skip_data(pfdata, data + i, len - i))
+                i += n - 1;
+
             else if (process_data(pfdata, ch))
             {
                 DebugMessage(DEBUG_SMTP, "Flush data!\n");
@@ -96,6 +96,19 @@ void SideChannel::set_message_port(SCMessage* msg, SCPort port)
     msg->hdr->port = port;
 }
 
+// trim an allocated message to the content actually written; the
+// content can only shrink
+void SideChannel::set_message_length(SCMessage* msg, uint32_t content_length)
+{
+    assert ( msg );
+    assert ( msg->handle );
+    assert ( content_length <= msg->content_length );
+
+    ConnectorMsg* cmsg = msg->connector->get_connector_msg(msg->handle);
+    cmsg->length = content_length + sizeof(SCMsgHdr);
+    msg->content_length = content_length;
+}
+
 void SideChannel::set_default_port(SCPort port)
 {
     default_port = port;
@@ -74,6 +74,7 @@ public:
     bool discard_message(SCMessage* msg);
     bool transmit_message(SCMessage* msg);
     void set_message_port(SCMessage* msg, SCPort port);
+    void set_message_length(SCMessage* msg, uint32_t content_length);
     void set_default_port(SCPort port);
     Connector::Direction get_direction();
 
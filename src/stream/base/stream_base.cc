@@ -77,6 +77,9 @@ const PegInfo base_pegs[] =
     PROTO_PEGS("udp"),
     PROTO_PEGS("user"),
     PROTO_PEGS("file"),
+    { "bypass packets", "packets on trusted flows that took the fast path" },
+    { "bypass bytes", "bytes on trusted flows that took the fast path" },
+    { "bypass revalidations", "bypassed flows sent back through the normal path" },
     { nullptr, nullptr }
 };
 
@@ -93,6 +96,10 @@ void base_sum()
     SET_PROTO_COUNTS(user, PDU);
     SET_PROTO_COUNTS(file, FILE);
 
+    stream_base_stats.bypass_packets = flow_con->get_bypass_packets();
+    stream_base_stats.bypass_bytes = flow_con->get_bypass_bytes();
+    stream_base_stats.bypass_revalidations = flow_con->get_bypass_revalidations();
+
     sum_stats((PegCount*)&g_stats, (PegCount*)&stream_base_stats,
         array_size(base_pegs)-1);
 }
@@ -156,6 +163,7 @@ void StreamBase::tinit()
 {
     assert(!flow_con);
     flow_con = new FlowControl;
+    flow_con->set_bypass_timeout(config.bypass_timeout);
     InspectSsnFunc f;
 
     StreamHAManager::tinit();
@@ -59,6 +59,9 @@ static const Parameter s_params[] =
     { "ip_frags_only", Parameter::PT_BOOL, nullptr, "false",
       "don't process non-frag flows" },
 
+    { "bypass_timeout", Parameter::PT_INT, "0:", "0",
+      "seconds trusted flows take the fast path before revalidation (0 = disable)" },
+
     CACHE_TABLE("ip_cache",   "ip",   ip_params),
     CACHE_TABLE("icmp_cache", "icmp", icmp_params),
     CACHE_TABLE("tcp_cache",  "tcp",  tcp_params),
@@ -104,6 +107,11 @@ bool StreamModule::set(const char* fqn, Value& v, SnortConfig*)
         config.ip_frags_only = v.get_bool();
         return true;
     }
+    else if ( v.is("bypass_timeout") )
+    {
+        config.bypass_timeout = v.get_long();
+        return true;
+    }
     else if ( strstr(fqn, "ip_cache") )
         fc = &config.ip_cfg;
 
@@ -53,6 +53,9 @@ struct BaseStats
     PROTO_FIELDS(udp);
     PROTO_FIELDS(user);
     PROTO_FIELDS(file);
+    PegCount bypass_packets;
+    PegCount bypass_bytes;
+    PegCount bypass_revalidations;
 };
 
 extern const PegInfo base_pegs[];
@@ -67,6 +70,7 @@ struct StreamModuleConfig
     FlowConfig udp_cfg;
     FlowConfig user_cfg;
     FlowConfig file_cfg;
+    unsigned bypass_timeout;
     bool ip_frags_only;
 };
 
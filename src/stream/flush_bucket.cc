@@ -25,6 +25,7 @@
 #include <random>
 
 #include "main/snort_config.h"
+#include "memory/memory_cap.h"
 #include "protocols/packet.h"
 
 //-------------------------------------------------------------------------
@@ -58,7 +59,13 @@ void FlushBucket::clear()
 
 uint16_t FlushBucket::get_size()
 {
-    return s_flush_bucket->get_next();
+    uint16_t size = s_flush_bucket->get_next();
+
+    // flush sooner to hold less data under memory pressure
+    if ( memory::MemoryCap::get_tier() >= memory::MemoryCap::TIER_FLUSH )
+        size >>= 1;
+
+    return size;
 }
 
 //-------------------------------------------------------------------------
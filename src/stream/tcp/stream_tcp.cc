@@ -29,6 +29,7 @@
 #include "stream_tcp.h"
 #include "tcp_ha.h"
 #include "tcp_module.h"
+#include "tcp_segment_node.h"
 #include "tcp_session.h"
 
 //-------------------------------------------------------------------------
@@ -134,6 +135,7 @@ static void tcp_tterm()
 {
     TcpSession::sterm();
     FlushBucket::clear();
+    TcpSegmentNode::clear();
 }
 
 static const InspectApi tcp_api =
@@ -55,6 +55,7 @@ const PegInfo tcp_pegs[] =
     { "data trackers", "tcp session tracking started on data" },
     { "segs queued", "total segments queued" },
     { "segs released", "total segments released" },
+    { "segs recycled", "segments queued in recycled buffers" },
     { "segs split", "tcp segments split when reassembling PDUs" },
     { "segs used", "queued tcp segments applied to reassembled PDUs" },
     { "rebuilt packets", "total reassembled PDUs" },
@@ -64,6 +65,8 @@ const PegInfo tcp_pegs[] =
     { "gaps", "missing data between PDUs" },
     { "max segs", "number of times the maximum queued segment limit was reached" },
     { "max bytes", "number of times the maximum queued byte limit was reached" },
+    { "degraded segs", "segments not queued for flows without a service inspector "
+      "due to memory pressure" },
     { "internal events", "135:X events generated" },
     { "client cleanups", "number of times data from server was flushed when session released" },
     { "server cleanups", "number of times data from client was flushed when session released" },
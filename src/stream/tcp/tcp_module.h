@@ -80,6 +80,7 @@ struct TcpStats
     PegCount sessions_on_data;
     PegCount segs_queued;
     PegCount segs_released;
+    PegCount segs_recycled;
     PegCount segs_split;
     PegCount segs_used;
     PegCount rebuilt_packets;   //iStreamFlushes
@@ -89,6 +90,7 @@ struct TcpStats
     PegCount gaps;
     PegCount max_segs;
     PegCount max_bytes;
+    PegCount degraded_segs;
     PegCount internalEvents;
     PegCount s5tcp1;
     PegCount s5tcp2;
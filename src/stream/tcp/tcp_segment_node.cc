@@ -21,11 +21,32 @@
 
 #include "tcp_segment_node.h"
 
+#include <new>
+
 #include "flow/flow_control.h"
 #include "protocols/packet.h"
 #include "utils/util.h"
 #include "tcp_module.h"
 
+// each segment is a single block with the payload right after the node so
+// queuing costs one allocation and one copy and the node and its data
+// share cache lines.  blocks are sized to the payload except for segments
+// that nearly fill a block big enough for a full sized ethernet segment;
+// those share one block size and are kept on a short per thread free list
+// so in order data is usually queued without going to the heap at all.
+// small segments never hold a whole block and the free list only holds
+// blocks that were mostly used.
+static const unsigned seg_block_size = 1536;
+static const unsigned max_block_dsize = seg_block_size - sizeof(TcpSegmentNode);
+static const unsigned min_block_dsize = 1024;
+static const unsigned max_free_blocks = 256;
+
+static inline bool use_block(unsigned dsize)
+{ return dsize >= min_block_dsize && dsize <= max_block_dsize; }
+
+static THREAD_LOCAL TcpSegmentNode* free_blocks = nullptr;
+static THREAD_LOCAL unsigned free_count = 0;
+
 // FIXIT-P this is going to set each member 2X; once here and once in init
 // separate ctors with default initializers would set them only once
 TcpSegmentNode::TcpSegmentNode() :
@@ -35,11 +56,6 @@ TcpSegmentNode::TcpSegmentNode() :
 {
 }
 
-TcpSegmentNode::~TcpSegmentNode()
-{
-    // TODO Auto-generated destructor stub
-}
-
 //-------------------------------------------------------------------------
 // TcpSegment stuff
 //-------------------------------------------------------------------------
@@ -55,8 +71,23 @@ TcpSegmentNode* TcpSegmentNode::init(TcpSegmentNode& tsn)
 
 TcpSegmentNode* TcpSegmentNode::init(const struct timeval& tv, const uint8_t* data, unsigned dsize)
 {
-    TcpSegmentNode* ss = new TcpSegmentNode;
-    ss->data = ( uint8_t* )snort_alloc(dsize);
+    void* block;
+
+    if ( !use_block(dsize) )
+        block = snort_alloc(sizeof(TcpSegmentNode) + dsize);
+
+    else if ( free_blocks )
+    {
+        block = free_blocks;
+        free_blocks = free_blocks->next;
+        free_count--;
+        tcpStats.segs_recycled++;
+    }
+    else
+        block = snort_alloc(seg_block_size);
+
+    TcpSegmentNode* ss = new(block) TcpSegmentNode;
+    ss->data = (uint8_t*)(ss + 1);
     memcpy(ss->data, data, dsize);
     ss->offset = 0;
     ss->tv = tv;
@@ -68,10 +99,28 @@ TcpSegmentNode* TcpSegmentNode::init(const struct timeval& tv, const uint8_t* da
 
 void TcpSegmentNode::term()
 {
-    snort_free(data);
     tcpStats.segs_released++;
     tcpStats.mem_in_use -= orig_dsize;
-    delete this;
+
+    if ( use_block(orig_dsize) && free_count < max_free_blocks )
+    {
+        next = free_blocks;
+        free_blocks = this;
+        free_count++;
+    }
+    else
+        snort_free(this);
+}
+
+void TcpSegmentNode::clear()
+{
+    while ( free_blocks )
+    {
+        TcpSegmentNode* tsn = free_blocks;
+        free_blocks = tsn->next;
+        snort_free(tsn);
+    }
+    free_count = 0;
 }
 
 bool TcpSegmentNode::is_retransmit(const uint8_t* rdata, uint16_t rsize, uint32_t rseq, uint16_t orig_dsize, bool *full_retransmit)
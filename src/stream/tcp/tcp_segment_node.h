@@ -37,12 +37,14 @@
 struct TcpSegmentNode
 {
     TcpSegmentNode();
-    ~TcpSegmentNode();
 
     static TcpSegmentNode* init(TcpSegmentDescriptor& tsd);
     static TcpSegmentNode* init(TcpSegmentNode& tsn);
     static TcpSegmentNode* init(const struct timeval&, const uint8_t*, unsigned);
 
+    // release this thread's recycled segment blocks
+    static void clear();
+
     void term();
     bool is_retransmit(const uint8_t*, uint16_t size, uint32_t, uint16_t, bool*);
 
@@ -52,7 +54,7 @@ struct TcpSegmentNode
     TcpSegmentNode* prev;
     TcpSegmentNode* next;
 
-    uint8_t* data;
+    uint8_t* data;  // follows this node in the same block
 
     struct timeval tv;
     uint32_t ts;
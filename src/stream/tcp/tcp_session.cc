@@ -74,6 +74,7 @@
 #include "file_api/file_api.h"
 #include "perf_monitor/flow_tracker.h"
 #include "filters/sfrf.h"
+#include "memory/memory_cap.h"
 
 #include "stream/paf.h"
 #include "stream_tcp.h"
@@ -317,6 +318,15 @@ bool TcpSession::flow_exceeds_config_thresholds(TcpSegmentDescriptor& tsd)
         }
     }
 
+    // under memory pressure stop buffering for flows that only raw
+    // detection would look at
+    if ( !flow->gadget && !flow->clouseau
+        && memory::MemoryCap::get_tier() >= memory::MemoryCap::TIER_BUFFER )
+    {
+        tcpStats.degraded_segs++;
+        return true;
+    }
+
     if ( config->max_queued_bytes
         && ( listener->reassembler->get_seg_bytes_total() > config->max_queued_bytes ) )
     {
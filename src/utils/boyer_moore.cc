@@ -56,6 +56,10 @@
 #include "main/snort_debug.h"
 #include "utils/util.h"
 
+#ifdef UNIT_TEST
+#include "catch/catch.hpp"
+#endif
+
 /****************************************************************
  *
  *  Function: make_skip(char *, int)
@@ -229,3 +233,162 @@ int mSearchCI(
     return -1;
 }
 
+/****************************************************************
+ *
+ *  Function: mSearchShort(char *, int, char *, int)
+ *
+ *  Purpose: Determines if a string contains a (non-regex)
+ *           substring without skip or shift tables.  memchr()
+ *           finds candidates by first byte and the last byte is
+ *           checked before the rest of the pattern.  This beats
+ *           Boyer-Moore for short patterns where the B-M strides
+ *           are too small to pay for the table lookups.
+ *
+ *  Parameters:
+ *      buf => data buffer we want to find the data in
+ *      blen => data buffer length
+ *      ptrn => pattern to find
+ *      plen => length of the data in the pattern buffer
+ *
+ *  Returns:
+ *      -1 if not found or offset >= 0 if found
+ *
+ ****************************************************************/
+int mSearchShort(const char* buf, int blen, const char* ptrn, int plen)
+{
+    if ( plen <= 0 or plen > blen )
+        return -1;
+
+    const char first = ptrn[0];
+    const char last = ptrn[plen - 1];
+    const int mid = plen > 2 ? plen - 2 : 0;
+
+    const char* p = buf;
+    const char* end = buf + blen - plen + 1;
+
+    while ( p < end )
+    {
+        p = (const char*)memchr(p, first, end - p);
+
+        if ( !p )
+            return -1;
+
+        if ( p[plen - 1] == last and !memcmp(p + 1, ptrn + 1, mid) )
+            return p - buf;
+
+        ++p;
+    }
+
+    return -1;
+}
+
+/****************************************************************
+ *
+ *  Function: mSearchShortCI(char *, int, char *, int)
+ *
+ *  Purpose: Case insensitive version of mSearchShort.  As with
+ *           mSearchCI, the pattern must already be upper case.
+ *
+ *  Parameters:
+ *      buf => data buffer we want to find the data in
+ *      blen => data buffer length
+ *      ptrn => upper case pattern to find
+ *      plen => length of the data in the pattern buffer
+ *
+ *  Returns:
+ *      -1 if not found or offset >= 0 if found
+ *
+ ****************************************************************/
+int mSearchShortCI(const char* buf, int blen, const char* ptrn, int plen)
+{
+    if ( plen <= 0 or plen > blen )
+        return -1;
+
+    const unsigned char first = ptrn[0];
+    const unsigned char last = ptrn[plen - 1];
+
+    const char* p = buf;
+    const char* end = buf + blen - plen + 1;
+
+    // a leading letter matches both cases; anything else can use memchr
+    const bool alpha = isupper(first);
+
+    while ( p < end )
+    {
+        if ( alpha )
+        {
+            // clearing 0x20 maps exactly the lower case letter to first
+            while ( p < end and ((unsigned char)*p & 0xDF) != first )
+                ++p;
+
+            if ( p == end )
+                return -1;
+        }
+        else if ( !(p = (const char*)memchr(p, first, end - p)) )
+            return -1;
+
+        if ( toupper((unsigned char)p[plen - 1]) == last )
+        {
+            int i = 1;
+
+            while ( i < plen - 1 and
+                toupper((unsigned char)p[i]) == (unsigned char)ptrn[i] )
+                ++i;
+
+            if ( i >= plen - 1 )
+                return p - buf;
+        }
+        ++p;
+    }
+
+    return -1;
+}
+
+#ifdef UNIT_TEST
+static int bm_search(const char* buf, const char* pat, bool no_case)
+{
+    int len = strlen(pat);
+    int* skip = make_skip(pat, len);
+    int* shift = make_shift(pat, len);
+
+    int found = no_case ?
+        mSearchCI(buf, strlen(buf), pat, len, skip, shift) :
+        mSearch(buf, strlen(buf), pat, len, skip, shift);
+
+    snort_free(skip);
+    snort_free(shift);
+    return found;
+}
+
+TEST_CASE("short search matches boyer-moore", "[boyer_moore]")
+{
+    const char* buf = "GET /a/b.php?x=AbCd HTTP/1.1\r\nHost: x\r\n\r\n";
+    const char* pats[] =
+    { "G", "\n", "b.php", "ABCD", "HTTP/1.1\r\n", "\r\n\r\n", "xyz", "Host: x\r\n\r\n!" };
+
+    for ( auto pat : pats )
+    {
+        std::string upper(pat);
+
+        for ( auto& c : upper )
+            c = toupper(c);
+
+        CHECK(mSearchShort(buf, strlen(buf), pat, strlen(pat)) == bm_search(buf, pat, false));
+        CHECK(mSearchShortCI(buf, strlen(buf), upper.c_str(), upper.size()) ==
+            bm_search(buf, upper.c_str(), true));
+    }
+}
+
+TEST_CASE("short search bounds", "[boyer_moore]")
+{
+    const char* buf = "aaab";
+
+    CHECK(mSearchShort(buf, 4, "ab", 2) == 2);
+    CHECK(mSearchShort(buf, 3, "ab", 2) == -1);
+    CHECK(mSearchShort(buf, 4, "aaab", 4) == 0);
+    CHECK(mSearchShort(buf, 4, "aaaab", 5) == -1);
+    CHECK(mSearchShort(buf, 4, "", 0) == -1);
+    CHECK(mSearchShortCI(buf, 4, "AB", 2) == 2);
+    CHECK(mSearchShortCI(buf, 3, "AB", 2) == -1);
+}
+#endif
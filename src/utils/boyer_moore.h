@@ -32,5 +32,9 @@ SO_PUBLIC int* make_shift(const char*, int);
 SO_PUBLIC int mSearch(const char*, int, const char*, int, int*, int*);
 SO_PUBLIC int mSearchCI(const char*, int, const char*, int, int*, int*);
 
+// table free search for short patterns
+SO_PUBLIC int mSearchShort(const char*, int, const char*, int);
+SO_PUBLIC int mSearchShortCI(const char*, int, const char*, int);
+
 #endif
 
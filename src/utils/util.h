@@ -39,6 +39,7 @@
 #include <sys/syscall.h>
 #endif
 
+#include <new>
 #include <string>
 
 #include "main/snort_types.h"
@@ -127,6 +128,22 @@ inline void* snort_calloc(size_t sz)
 inline void snort_free(void* p)
 { delete[] (uint8_t*)p; }
 
+// zeroed storage with the given alignment; release with snort_free_aligned()
+inline void* snort_calloc_aligned(size_t align, size_t num, size_t sz)
+{
+    void* p;
+    sz *= num;
+
+    if ( posix_memalign(&p, align, sz) )
+        throw std::bad_alloc();
+
+    memset(p, 0, sz);
+    return p;
+}
+
+inline void snort_free_aligned(void* p)
+{ free(p); }
+
 inline long SnortStrtol(const char* nptr, char** endptr, int base)
 {
     long iRet;
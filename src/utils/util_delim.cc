@@ -0,0 +1,143 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// util_delim.cc
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "util_delim.h"
+
+#include <cstring>
+
+#ifdef UNIT_TEST
+#include <string>
+
+#include "catch/catch.hpp"
+#endif
+
+static const uint64_t ones = 0x0101010101010101ULL;
+static const uint64_t highs = 0x8080808080808080ULL;
+
+// nonzero iff some byte of w is zero
+static inline uint64_t has_zero(uint64_t w)
+{ return (w - ones) & ~w & highs; }
+
+uint32_t find_eol(const uint8_t* data, uint32_t len)
+{
+    // libc memchr is already vectorized
+    const uint8_t* p = (const uint8_t*)memchr(data, '\n', len);
+    return p ? p - data : len;
+}
+
+uint32_t find_either(const uint8_t* data, uint32_t len, uint8_t a, uint8_t b)
+{
+    const uint64_t wa = ones * a;
+    const uint64_t wb = ones * b;
+    uint32_t i = 0;
+
+    for ( ; i + sizeof(uint64_t) <= len; i += sizeof(uint64_t) )
+    {
+        uint64_t w;
+        memcpy(&w, data + i, sizeof(w));
+
+        if ( has_zero(w ^ wa) | has_zero(w ^ wb) )
+            break;
+    }
+
+    for ( ; i < len; ++i )
+    {
+        if ( data[i] == a or data[i] == b )
+            return i;
+    }
+    return len;
+}
+
+#ifdef UNIT_TEST
+
+TEST_CASE ( "find delimiters", "[util_delim]" )
+{
+    const uint8_t* s = (const uint8_t*)"abcdefghijklmnop-qrstuvwxyz\r\n";
+    const uint32_t n = strlen((const char*)s);
+
+    SECTION( "eol" )
+    {
+        CHECK( find_eol(s, n) == n - 1 );
+        CHECK( find_eol(s, n - 1) == n - 1 );
+        CHECK( find_eol(s, 0) == 0 );
+    }
+
+    SECTION( "either" )
+    {
+        CHECK( find_either(s, n, '\n', '-') == 16 );
+        CHECK( find_either(s, n, '\n', 'x') == 24 );
+        CHECK( find_either(s, 16, '\n', '-') == 16 );
+        CHECK( find_either(s, n, '#', '$') == n );
+    }
+
+    SECTION( "every offset" )
+    {
+        uint8_t buf[40];
+
+        for ( unsigned at = 0; at < sizeof(buf); ++at )
+        {
+            memset(buf, 0xff, sizeof(buf));
+            buf[at] = '-';
+
+            for ( unsigned len = 0; len <= sizeof(buf); ++len )
+                CHECK( find_either(buf, len, '\n', '-') == (at < len ? at : len) );
+        }
+    }
+}
+
+TEST_CASE ( "find delimiters in a body", "[util_delim]" )
+{
+    // a base64 body: 76 byte lines with the occasional boundary marker
+    std::string body;
+
+    while ( body.size() < 4 * 1024 )
+    {
+        body += std::string(76, 'Q');
+        body += "\r\n";
+
+        if ( body.size() % 7 == 0 )
+            body += "--";
+    }
+    const uint8_t* data = (const uint8_t*)body.data();
+    const uint32_t len = body.size();
+    uint64_t stops = 0;
+
+    for ( uint32_t i = 0; i < len; ++i )
+        if ( data[i] == '\n' or data[i] == '-' )
+            ++stops;
+
+    uint64_t found = 0;
+
+    for ( uint32_t i = 0; i < len; ++i )
+    {
+        i += find_either(data + i, len - i, '\n', '-');
+
+        if ( i < len )
+            ++found;
+    }
+
+    CHECK( found == stops );
+}
+
+#endif
+
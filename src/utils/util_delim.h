@@ -0,0 +1,37 @@
+//--------------------------------------------------------------------------
+// Copyright (C) 2016 Cisco and/or its affiliates. All rights reserved.
+//
+// This program is free software; you can redistribute it and/or modify it
+// under the terms of the GNU General Public License Version 2 as published
+// by the Free Software Foundation.  You may not use, modify or distribute
+// this program under any other version of the GNU General Public License.
+//
+// This program is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+// General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License along
+// with this program; if not, write to the Free Software Foundation, Inc.,
+// 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+//--------------------------------------------------------------------------
+// util_delim.h
+
+#ifndef UTIL_DELIM_H
+#define UTIL_DELIM_H
+
+// delimiter searches shared by the protocol splitters.  these check a word
+// at a time so runs of bytes that can't be delimiters are passed over in
+// bulk instead of being fed one at a time to a per byte state machine.
+// each returns the offset of the first match or len if there is none.
+
+#include "main/snort_types.h"
+
+// first '\n'
+SO_PUBLIC uint32_t find_eol(const uint8_t* data, uint32_t len);
+
+// first a or b
+SO_PUBLIC uint32_t find_either(const uint8_t* data, uint32_t len, uint8_t a, uint8_t b);
+
+#endif
+
@@ -20,6 +20,8 @@
 
 #include "util_unfold.h"
 
+#include <string.h>
+
 /* Given a string, removes header folding (\r\n followed by linear whitespace)
  * and exits when the end of a header is found, defined as \n followed by a
  * non-whitespace.  This is especially helpful for HTML.
@@ -112,14 +114,39 @@ int sf_strip_CRLF(const uint8_t* inbuf, uint32_t inbuf_size, uint8_t* outbuf,
     cursor = inbuf;
     endofinbuf = inbuf + inbuf_size;
     outbuf_ptr = outbuf;
+
+    /* Copy whole lines at a time; line breaks are rare compared to data
+     * so finding them with memchr() beats testing every byte. */
     while ((cursor < endofinbuf) && (n < outbuf_size))
     {
-        if ((*cursor != '\n') && (*cursor != '\r'))
+        const uint8_t* eol = (const uint8_t*)memchr(cursor, '\n', endofinbuf - cursor);
+
+        if (!eol)
+            eol = endofinbuf;
+
+        while ((cursor < eol) && (n < outbuf_size))
         {
-            *outbuf_ptr++ = *cursor;
-            n++;
+            const uint8_t* cr = (const uint8_t*)memchr(cursor, '\r', eol - cursor);
+
+            if (!cr)
+                cr = eol;
+
+            uint32_t len = cr - cursor;
+
+            if (len > outbuf_size - n)
+                len = outbuf_size - n;
+
+            memcpy(outbuf_ptr, cursor, len);
+            outbuf_ptr += len;
+            cursor += len;
+            n += len;
+
+            if (cursor == cr && cr < eol)
+                cursor++;
         }
-        cursor++;
+
+        if (cursor == eol && eol < endofinbuf)
+            cursor++;
     }
 
     if (output_bytes)